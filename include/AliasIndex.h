@@ -0,0 +1,74 @@
+/**
+ * @file AliasIndex.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Hash index of device and slot aliases
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+class Device;
+
+/**
+ * @brief Maps device and slot aliases to the device and slot they name.
+ * An open addressing hash table with linear probing. Device aliases and the slot aliases of each device are kept in
+ * separate namespaces by mixing the owning device into the hash. The table does not hold a copy of the alias, the
+ * alias String held by the Device is the single copy and is compared on lookup. An entry whose alias no longer
+ * matches is therefore never returned even if the alias was changed without updating the index.
+ */
+class AliasIndex
+{
+  public:
+    AliasIndex();
+    ~AliasIndex();
+
+    /// @brief Index a device alias (slot<0) or a slot alias of the device
+    void add(Device* device, short slot, const char* alias);
+
+    /// @brief Remove the entry for a device alias (slot<0) or slot alias
+    void remove(Device* device, short slot, const char* alias);
+
+    /// @brief Remove every entry of a device
+    void remove(Device* device);
+
+    /// @brief Find the device with the given alias, or NULL
+    Device* findDevice(const char* alias) const;
+
+    /// @brief Find the slot of a device with the given alias, or -1
+    short findSlot(const Device* device, const char* alias) const;
+
+    /// @brief Remove all entries
+    void clear();
+
+    inline unsigned int count() const { return used; }
+
+    /// @brief FNV-1a hash of an alias
+    static uint32_t hash(const char* alias);
+
+  protected:
+    struct Entry {
+      uint32_t hash;      // hash of the alias mixed with the scope
+      Device* device;     // NULL if the entry is empty or deleted
+      short slot;         // slot number, -1 for the device alias, Deleted for a deleted entry
+    };
+
+    static const short Deleted = -2;
+
+    Entry* entries;
+    unsigned int capacity;      // always a power of 2
+    unsigned int used;          // live entries
+    unsigned int deleted;       // deleted entries still occupying the table
+
+    static uint32_t scoped(uint32_t h, const Device* scope);
+    bool matches(const Entry& e, uint32_t h, const Device* scope, const char* alias) const;
+    void grow();
+
+    // do not allow copying
+    AliasIndex(const AliasIndex& copy) = delete;
+    AliasIndex& operator=(const AliasIndex& copy) = delete;
+};
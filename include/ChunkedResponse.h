@@ -0,0 +1,47 @@
+/**
+ * @file ChunkedResponse.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Print output that sends a chunked Http response through a fixed size buffer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+// bytes of output collected before a chunk is sent
+#if !defined(CHUNKED_RESPONSE_BUFFER)
+#define CHUNKED_RESPONSE_BUFFER   512
+#endif
+
+/**
+ * @brief Sends anything printed to it as a chunked Http response.
+ * The response headers are sent when the object is created. Output is collected in a fixed buffer and sent as a chunk
+ * each time the buffer fills, so a page of any size can be sent without building it in a String first. The response
+ * is completed by end() or when the object goes out of scope.
+ */
+class ChunkedResponse : public Print
+{
+  public:
+    ChunkedResponse(ESP8266WebServer& _server, int code, const char* contentType);
+    virtual ~ChunkedResponse();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* data, size_t size);
+    using Print::write;
+
+    /// @brief send any buffered output as a chunk
+    virtual void flush();
+
+    /// @brief flush and complete the response
+    void end();
+
+  protected:
+    ESP8266WebServer& server;
+    char buffer[CHUNKED_RESPONSE_BUFFER];
+    size_t length;
+    bool ended;
+};
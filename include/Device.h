@@ -12,6 +12,8 @@
 
 #include "NimbleConfig.h"
 #include "SensorReading.h"
+#include "SlotHistory.h"
+#include "LatencyHistogram.h"
 #include "Devices.h"
 
 // Device Flags
@@ -42,20 +44,6 @@ class Device {
       JsonDefault      = JsonSlots
     } JsonFlags;
   
-    /**
-     * @brief Contains a single measurement or sensor reading.
-     * A device can contain one or more slots but the number of slots should stay constant. For each update,
-     * the device should measure and update the sensors associated with each slot. A sensor, such as DHT 
-     * humidity sensors, may update many slots in one call such as humidity, temperature and "feels-like" 
-     * temperature.
-     * 
-     */
-    class Slot {
-      public:
-        String alias;             /// slot alias (may be blank if not set)
-        SensorReading reading;    /// the most recent sensor reading
-    };
-
     /**
      * @brief Collects general operating statistics for a device.
      * 
@@ -69,10 +57,16 @@ class Device {
           int sensing;    /// errors reported by sensor (failure to sense)
         } errors;
 
+        LatencyHistogram updateMicros;    /// time taken by each handleUpdate() call
+        LatencyHistogram latenessMillis;  /// how long after its deadline each update started
+
         inline Statistics() : updates(0) { memset(&errors, 0, sizeof(errors)); }
         
         /// Serialize this statistics object to a JsonObject
         void toJson(JsonObject& target) const;
+
+        /// Write this statistics object as members of the currently open object of a Json stream
+        void toJson(JsonStream& json) const;
     };
 
   public:
@@ -128,19 +122,26 @@ class Device {
     /// For example a device, such as humidity, temperature or motion sensor, can be associted with a room name by setting an alias.
     inline String getAlias() const { return alias; }
 
+    /// @brief Set the device alias
+    /// Aliases must be changed through this method so lookups by alias find the device.
+    void setAlias(const String& _alias);
+
     /// @brief Return the number of slots for this device
     /// Although a device may have any number of slots up to MAX_SLOTS (typicall 256, configured in NimbleConfig.h) this count
     /// should not change once the sensor has been initialized and readings are taking place.
     inline short slotCount() const { return slots; }
 
-    /// @brief Get the alias for the given slot (if set)
-    String getSlotAlias(short slotIndex) const;
+    /// @brief Get the alias for the given slot, blank if not set
+    const String& getSlotAlias(short slotIndex) const;
 
     /// Set an alias on the given slot
-    void setSlotAlias(short slotIndex, String alias);
+    void setSlotAlias(short slotIndex, const String& alias);
+
+    /// @brief Operating statistics, the update timings are recorded by the device manager
+    inline const Statistics& getStatistics() const { return statistics; }
 
     /// find a slot number using its alias name
-    short findSlotByAlias(String slotAlias) const;
+    short findSlotByAlias(const String& slotAlias) const;
     
     /// Called when the device should start a new measurement
     virtual void handleUpdate();
@@ -156,6 +157,19 @@ class Device {
     /// Stale measurements should not typical exist, but may if the sensor hardware fails to respond or is busy.
     virtual bool isStale(unsigned long _now=0) const;
 
+    /// @brief Set the memory available to keep a history of past readings
+    /// The budget is shared evenly between the slots, 0 disables history. Existing history is discarded.
+    /// @param bytes The number of bytes of sample storage this device may use
+    void setHistoryBudget(size_t bytes);
+    inline size_t getHistoryBudget() const { return historyBudget; }
+
+    /// @brief Return the history of past readings for a slot, or NULL if this device keeps no history
+    const SlotHistory* getHistory(short slotIndex) const;
+
+    /// @brief Append the current reading of each slot to its history if it is newer than the last one recorded
+    /// Called by the framework after each handleUpdate().
+    void recordHistory();
+
     /// @brief return sensor reading for given slot index
     SensorReading& operator[](unsigned short slotIndex);
 
@@ -168,16 +182,26 @@ class Device {
     /// @brief Serialize all slot readings for this device into a Json array
     void jsonGetReadings(JsonObject& node) const;
 
+    /// @brief Write all slot readings for this device as a "slots" member of a Json stream
+    void jsonGetReadings(JsonStream& json) const;
+
     /// @brief Standard RestAPI response when retrieving sensor readings for this device.
     int toJson(JsonObject& target, JsonFlags displayFlags=JsonDefault) const;
 
+    /// @brief Write the standard RestAPI response as members of the currently open object of a Json stream
+    void toJson(JsonStream& json, JsonFlags displayFlags=JsonDefault) const;
+
+    /// @brief Stream the standard RestAPI response directly into the Http response
+    /// Memory use stays constant regardless of the number of slots.
+    int restJson(RestRequest& request, JsonFlags displayFlags) const;
+
     /// @brief RestAPI methods
     /// @{
     // unfortunately we cannot bind constants in the rest handlers so we have to create these inline ones
-    inline int restStatus(RestRequest& request) const { return toJson(request.response, JsonDefault); }
-    inline int restSlots(RestRequest& request) const { return toJson(request.response, JsonSlots); }
-    inline int restStatistics(RestRequest& request) const { return toJson(request.response, JsonStatistics); }
-    inline int restDetail(RestRequest& request) const { return toJson(request.response, (JsonFlags)(JsonSlots|JsonStatistics) ); }
+    inline int restStatus(RestRequest& request) const { return restJson(request, JsonDefault); }
+    inline int restSlots(RestRequest& request) const { return restJson(request, JsonSlots); }
+    inline int restStatistics(RestRequest& request) const { return restJson(request, JsonStatistics); }
+    inline int restDetail(RestRequest& request) const { return restJson(request, (JsonFlags)(JsonSlots|JsonStatistics) ); }
     /// @}
 
     /// @brief Return an endpoint node at the given path
@@ -198,8 +222,19 @@ class Device {
 
   protected:
     Devices* owner;
+
+    /// @brief Slots are kept as parallel arrays.
+    /// A slot holds the most recent reading of a single measurement. A device can have one or more slots but the
+    /// number of slots should stay constant. For each update the device should measure and update the sensors associated
+    /// with each slot. A sensor, such as DHT humidity sensors, may update many slots in one call such as humidity,
+    /// temperature and "feels-like" temperature. The readings are read on every update and scan so they are packed
+    /// together, the slot aliases are rarely used and only allocated once an alias is set.
+    /// @{
     unsigned short slots;
-    Slot* readings;
+    SensorReading* readings;    /// the most recent reading of each slot
+    String* slotAliases;        /// slot aliases, NULL if no slot alias was ever set
+    /// @}
+
     unsigned long flags;
 
     /// @brief Contains endpoints for this device only.
@@ -211,18 +246,42 @@ class Device {
     unsigned long updateInterval;
 
     /// @brief timestamp next update is scheduled for this device
+    /// If changed outside of handleUpdate() call delay() or owner->reschedule() so the update schedule is kept in order.
     unsigned long nextUpdate;
 
+    /// @brief position of this device in the owner's update schedule, or -1 if not scheduled
+    short scheduleIndex;
+
+    /// @brief position of this device in the owner's device table, or -1 if not managed
+    short ordinal;
+
+    /// @brief set when readings may have changed since they were copied into the owner's reading store
+    /// Writing a slot through operator[] sets this, a driver writing the readings array directly outside of
+    /// handleUpdate() must set it itself.
+    bool unpublished;
+
     /// @brief the current device state
     /// The state describes if the device is operating normally or possibly in a degraded state due to communication, hardware or other failure
     DeviceState state;
 
     /// track statistics for this device
     Statistics statistics;
+
+    /// @brief history of past readings, one per slot, or NULL if no history is kept
+    SlotHistory* history;
+    unsigned short historySlots;   /// number of slots history was allocated for
+    size_t historyBudget;          /// bytes of sample storage for history
     
     /// @brief create a fixed number of sensor slots
+    /// Existing readings and aliases are kept, new slots hold no reading.
     void alloc(unsigned short _slots);
 
+    /// @brief release the slot storage
+    void freeSlots();
+
+    /// @brief make our slots a copy of another device's slots
+    void copySlots(const Device& copy);
+
     // todo: @deprecate the use of prefixUrl
     String prefixUri(const String& uri, short slot=-1) const;
     
@@ -238,6 +297,7 @@ class Device {
     void setOwner(Devices* owner);
     
     friend class Devices;
+    friend class AliasIndex;
 };
 
 extern Device NullDevice;
@@ -19,6 +19,8 @@
 
 #include "NimbleConfig.h"
 #include "SensorReading.h"
+#include "AliasIndex.h"
+#include "ReadingStore.h"
 
 
 class Devices;
@@ -59,6 +61,8 @@ class Devices {
         ReadingIterator& Before(unsigned long ts);
         ReadingIterator& After(unsigned long ts);
     
+        // returns the next matching reading
+        // when a time filter is set, past readings from the slot history are returned before the current reading
         SensorReading next();
         
       protected:
@@ -66,6 +70,18 @@ class Devices {
         bool singleDevice;
         short deviceOrdinal;
 
+        // rows of the manager's reading store still to scan
+        unsigned int row, rowEnd;
+        unsigned int typeCursor;   // position in the store's rows of the filtered type
+
+        // position within the history of the current slot, history is only searched if a time filter was set
+        bool timeFiltered;
+        static const unsigned short HistoryDone = 0xffff;
+        unsigned short historyPos;
+        unsigned long historyTs;
+
+        bool matches(const SensorReading& r) const;
+
         ReadingIterator(Devices* manager);
 
         // web handlers
@@ -88,7 +104,7 @@ class Devices {
     };*/
     
 public:
-    Devices(short maxDevices=32);
+    Devices(short maxDevices=MAX_DEVICES);
     ~Devices();
 
     void begin(WebServer& _http, NTPClient& client);
@@ -106,8 +122,8 @@ public:
     Device& find(short deviceId);
 
     // find a device by its alias
-    const Device& find(String deviceAlias) const;
-    Device& find(String deviceAlias);
+    const Device& find(const String& deviceAlias) const;
+    Device& find(const String& deviceAlias);
 
     // find a reading by device:slot
     // for convenience, but if you are reading multiple values you should get the device ptr then read the slots (readings)
@@ -115,20 +131,45 @@ public:
     SensorReading getReading(const SensorAddress& sa) const;
 
     // determine which devices need to interact with their hardware
+    // every device whose deadline has passed is updated, earliest deadline first, until the update budget is spent
     void handleUpdate();
 
+    /// @brief Set the time handleUpdate() may spend updating devices in a single call
+    /// At least one due device is always updated so a slow device cannot starve the others. Remaining due devices
+    /// are updated on the next call.
+    /// @param micros The budget in microseconds, 0 updates only one device per call.
+    inline void setUpdateBudget(unsigned long micros) { updateBudget = micros; }
+    inline unsigned long getUpdateBudget() const { return updateBudget; }
+
+    /// @brief Milliseconds until the next device update is due
+    /// The main loop can sleep this long without delaying a device. Returns 0 if an update is already due or
+    /// NoUpdateScheduled if there are no devices.
+    unsigned long timeUntilNextUpdate(unsigned long _now=0) const;
+
+    /// @brief Re-position a device in the update schedule after its nextUpdate deadline changed
+    void reschedule(Device& dev);
+
+    /// @brief Copy the readings of devices that changed into the reading store scanned by forEach() iterators
+    /// Iterators do this before they scan so it is rarely needed elsewhere.
+    void publish();
+
+    static const unsigned long NoUpdateScheduled = 0xffffffff;
+
     // iterate every reading available
     ReadingIterator forEach();
 
     // iterator readings from a deviceId
     ReadingIterator forEach(short deviceId);
 
-    // get an iterator over a type of reading
+    // get an iterator over a type of reading, only the slots of the type are visited
     ReadingIterator forEach(SensorType st);
 
     // generate a file of all device and slot aliases
     String getAliasesFile();
 
+    // print the file of all device and slot aliases, returns the number of characters printed
+    size_t printAliasesFile(Print& out);
+
     // parse a file of device and/or slot aliases and set where possible
     int parseAliasesFile(const char* aliases);
 
@@ -154,16 +195,42 @@ public:
     void jsonGetDevices(JsonObject& root);
     void jsonForEachBySensorType(JsonObject& root, ReadingIterator& itr, bool detailedValues=true);
 
+    // streaming json interface, members are written into the currently open object of the stream
+    void jsonGetDevices(JsonStream& json);
+    void jsonForEachBySensorType(JsonStream& json, bool detailedValues=true);
+
     static void registerDriver(const DeviceDriverInfo* driver);
     
   protected:
-    short update_iterator;  // ordinal of next device update
+    /// @brief update schedule, a binary min-heap of devices ordered by Device::nextUpdate
+    /// Devices track their own position in the heap so a changed deadline can be re-positioned in O(log n).
+    Device** schedule;
+    short scheduled;
+    unsigned long updateBudget;  // microseconds handleUpdate() may spend per call
+
+    /// @brief device and slot aliases of all devices, kept up to date by Device::setAlias() and Device::setSlotAlias()
+    AliasIndex aliasIndex;
+
+    /// @brief current readings of all devices in columns, scanned by ReadingIterator
+    ReadingStore store;
+
     NTPClient* ntp;
     WebServer* httpServer;
     RestRequestHandler* restHandler;
     
     void alloc(short n);
 
+    // copy the readings of a device into the reading store
+    void publish(Device& dev);
+
+    // update schedule (min-heap) operations
+    void schedulePush(Device* dev);
+    void scheduleRemove(Device* dev);
+    void scheduleUp(short i);
+    void scheduleDown(short i);
+    inline void schedulePlace(short i, Device* dev);
+    static inline bool scheduledBefore(const Device* a, const Device* b);
+
     // do not allow copying
     Devices(const Devices& copy) = delete;
     Devices& operator=(const Devices& copy) = delete;
@@ -175,6 +242,8 @@ public:
 
     void setupRestHandler();
     static const DeviceDriverInfo* findDriver(const char* name);
+
+    friend class Device;
 };
 
 extern Devices DeviceManager;
@@ -1,22 +1,81 @@
-
 #pragma once
 
 
 #include "NimbleAPI.h"
 
+/**
+ * @brief A digital input such as a switch, a reed contact or a PIR motion sensor.
+ * By default the pin is polled on each update and slot 0 holds its state.
+ *
+ * With edge capture the pin interrupt timestamps every edge into a small queue and each update works through the
+ * queued edges, so pulses shorter than the update interval are still seen and the interval can be seconds. Slot 0 is
+ * then active if the pin was active at any time since the previous update, and the extra slots hold:
+ *   1  the number of pulses (active edges) since the device started
+ *   2  the length in milliseconds of the last pulse, timestamped with the time it ended
+ *   3  the fraction of the previous update interval the pin was active
+ * Edges that arrive while the queue is full are dropped and counted as sensing errors, the level is resynchronized
+ * from the next edge.
+ */
 class DigitalPin : public Device
 {
   public:
-    DigitalPin(short id, SensorType _pinType, int _pin, unsigned long _updateInterval=1000, bool _reversePolarity=false);
+    /// @brief slots of a pin that captures edges
+    enum EdgeSlot {
+      StateSlot,
+      PulsesSlot,
+      LastPulseSlot,
+      OnRatioSlot,
+      EdgeSlots
+    };
+
+    DigitalPin(short id, SensorType _pinType, int _pin, unsigned long _updateInterval=1000, bool _reversePolarity=false, bool _captureEdges=false);
     DigitalPin(const DigitalPin& copy);
     DigitalPin& operator=(const DigitalPin& copy);
+    virtual ~DigitalPin();
 
     virtual const char* getDriverName() const;
 
+    virtual void begin();
     virtual void handleUpdate();
 
+    inline bool capturesEdges() const { return captureEdges; }
+
   public:
     SensorType pinType;
     int pin;
     bool reversePolarity;
+
+  protected:
+    bool captureEdges;
+    bool attached;
+
+    /// @brief Edges captured by the interrupt handler.
+    /// The interrupt handler is the only writer of head and the update the only writer of tail, so neither needs
+    /// interrupts disabled.
+    /// @{
+    struct Edge {
+      unsigned long at;         // micros() when the edge was seen
+      bool level;               // pin level read in the interrupt, before polarity is applied
+    };
+    Edge edges[DIGITAL_EDGE_QUEUE];
+    volatile unsigned short head;
+    volatile unsigned short tail;
+    volatile unsigned short overruns;
+    /// @}
+    unsigned short overrunsSeen;
+
+    // state of the pin as of the last edge processed
+    bool active;
+    unsigned long activeSince;    // micros of the last edge
+    unsigned long pulseStart;     // micros of the last active edge
+    unsigned long onMicros;       // time active since the last update
+    unsigned long intervalStart;  // micros of the last update
+    bool wasActive;               // active at any time since the last update
+    long pulses;
+
+    static void onEdge(void* arg);
+
+    void attach();
+    void detach();
+    void updateFromEdges();
 };
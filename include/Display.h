@@ -14,6 +14,23 @@
 #endif
 
 #include "NimbleAPI.h"
+#include "FrameBuffer.h"
+#include "TrendSeries.h"
+
+// I2C address of the display controller
+#if !defined(DISPLAY_I2C_ADDRESS)
+#define DISPLAY_I2C_ADDRESS   0x3C
+#endif
+
+// maximum number of trend series kept for the sparklines of all pages
+#if !defined(DISPLAY_MAX_TRENDS)
+#define DISPLAY_MAX_TRENDS    4
+#endif
+
+// bytes of display data sent per I2C transmission when flushing part of the framebuffer
+#if !defined(DISPLAY_FLUSH_CHUNK)
+#define DISPLAY_FLUSH_CHUNK   16
+#endif
 
 #define FONT(name)  { &name, #name }
 
@@ -27,7 +44,8 @@ typedef enum {
 	SyntaxError,
 	InvalidRegister,
 	ExpectedRegister,
-	ExpectedNumeric
+	ExpectedNumeric,
+	UnknownCommand
 } ParseExceptionCode;
 
 typedef struct _ParseException {
@@ -38,7 +56,48 @@ typedef struct _ParseException {
 
 const char* ParseExceptionCodeToString(ParseExceptionCode code);
 
-
+// operations of a compiled display page
+typedef enum {
+  OpSetX,         // cursor x = a
+  OpSetY,         // cursor y = a
+  OpMoveX,        // cursor x += a
+  OpMoveY,        // cursor y += a
+  OpSnapX,        // cursor x = (x/a)*a + b, snap to the grid column then move
+  OpSnapY,        // cursor y = (y/a)*a + b
+  OpTextSize,     // text size = arg
+  OpFont,         // font = font
+  OpText,         // print b characters of the page code starting at a
+  OpReading,      // print reading of device a slot b with arg decimals
+  OpLine,         // line from the cursor to the cursor + (a,b)
+  OpRect,         // rectangle at the cursor, a wide and b high
+  OpFillRect,
+  OpCircle,       // circle centered on the cursor with radius a
+  OpFillCircle,
+  OpBox,          // size of the following graph, a wide and b high
+  OpRange,        // value range of the following graph, a to b
+  OpPeriod,       // minutes of readings covered by the following sparkline
+  OpBar,          // bar graph at the cursor of the reading of device a slot b
+  OpSparkline     // plot of the trend series arg of device a slot b at the cursor
+} DisplayOp;
+
+/**
+ * @brief One instruction of a compiled display page.
+ * Register values, grid sizes and fonts are resolved when the page is compiled, only the cursor position is left
+ * to be tracked when the page is drawn since it depends on the width of the text printed.
+ */
+typedef struct _DisplayInstruction {
+  uint8_t op;             // DisplayOp
+  uint8_t arg;
+  short a, b;
+  const GFXfont* font;
+} DisplayInstruction;
+
+/**
+ * @brief A display page in G-code along with its compiled instructions.
+ * The code is compiled by Display::compile() when the page is loaded or posted so drawing a frame only walks the
+ * instruction list. If the code has an error the instructions up to the error are kept and the error is available
+ * from error().
+ */
 class DisplayPage
 {
   public:
@@ -56,9 +115,27 @@ class DisplayPage
 
     inline const char* code() const { return _code; }
 
+    /// @brief true if the page was compiled, even if only partially due to an error
+    inline bool isCompiled() const { return program!=NULL; }
+
+    /// @brief true if the code compiled without error
+    inline bool hasError() const { return error.code != 0; }
+
+    /// @brief location and type of the first error found when compiling
+    inline const ParseException& getError() const { return error; }
+
   protected:
     const char* _code;
     bool owns_mem;
+
+    DisplayInstruction* program;
+    short programLength;
+    short programCapacity;
+    ParseException error;
+
+    void clearProgram();
+
+    friend class Display;
 };
 
 class Display : public Device
@@ -67,6 +144,9 @@ class Display : public Device
     Adafruit_SSD1306 display;
     const FontInfo* fonts;
     short nfonts;
+
+    // time taken by each flush to the panel
+    LatencyHistogram flushMicros;
     
   public:
   	Display(short id=1);
@@ -80,6 +160,7 @@ class Display : public Device
   	void setFontTable(const FontInfo (&_fonts)[N]) { 
   	  fonts = _fonts; 
   	  nfonts = (short)N; 
+  	  compileAllPages();   // font pointers are resolved at compile time
   	}
 
     short addPage(const DisplayPage& page);
@@ -93,7 +174,22 @@ class Display : public Device
    
   	short& getRegister(char reg);
   
-  	// parse a program
+  	// compile the page code into instructions, returns false if the code has an error
+  	bool compile(DisplayPage& page);
+
+  	// compile every loaded page
+  	void compileAllPages();
+
+  	// draw a compiled page
+  	void render(const DisplayPage& page);
+
+  	// true if a reading drawn by the page changed since it was last drawn, or the page must be redrawn anyway
+  	bool needsRedraw(const DisplayPage& page);
+
+  	// send the parts of the framebuffer that changed since the last flush to the display
+  	void flush();
+
+  	// compile and draw a program
   	bool execute(const char* input, ParseException* pex=NULL);
   
 	protected:
@@ -102,7 +198,7 @@ class Display : public Device
     short activePage;
 
 		// list of gcode registers
-		short G, D, S, _F, X, Y, U, P, R, T, C, W, H;
+		short G, D, S, _F, X, Y, U, P, R, T, C, W, H, A, B;
 
 		// working var, also target of invalid register
 		short w;
@@ -117,15 +213,44 @@ class Display : public Device
     // coordinate mode
     bool relativeCoords;  // default: false
 
-    // reset parser and display getting ready for a new page draw
+    // the readings as last drawn by the active page, one per reading instruction
+    SensorReading* drawn;
+    short ndrawn;
+    bool redraw;          // set to force the next update to draw the active page
+
+    // copy of what the panel currently shows, the framebuffer is compared with it to find what changed
+    uint8_t* panel;
+
+    // downsampled readings plotted by sparklines, instructions refer to them by index
+    TrendSeries* trends[DISPLAY_MAX_TRENDS];
+    bool trendChanged[DISPLAY_MAX_TRENDS];    // series that changed since the active page was last checked
+    short ntrends;
+
+    // reset parser registers getting ready to compile a new page
     void reset();
 
-    // execute based on the value of the registers
-    bool exec();
+    // send the parts of the framebuffer that differ from the panel
+    void sendChanges();
+
+    // emit the instructions for the command in the registers
+    bool exec(DisplayPage& page, const char* code);
+
+    // append an instruction to the page program
+    void emit(DisplayPage& page, uint8_t op, short a=0, short b=0, uint8_t arg=0, const GFXfont* font=NULL);
 
     void print(const char* str, short strLength);
-    void print(SensorReading r);
-    void setCursorRC(short r, short c);
+    void print(const SensorReading& r, uint8_t precision);
+
+    // graph the value of a reading in a box at the cursor
+    void bar(FrameBuffer& fb, const SensorReading& r, short w, short h, short lo, short hi);
+    void sparkline(FrameBuffer& fb, const TrendSeries& series, short h, short lo, short hi);
+
+    // keep a trend series for each sparkline of the loaded pages and an extra page being compiled, dropping series no
+    // longer used. Series of a temporary extra page are released by the next call without it.
+    void bindTrends(DisplayPage* extra=NULL);
+
+    // add new readings to the trend series, marking the series that changed
+    void feedTrends();
 
     // Rest interface
     void httpPageSetActivePage();
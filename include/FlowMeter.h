@@ -0,0 +1,77 @@
+/**
+ * @file FlowMeter.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Pulse counting flow meter such as a hall effect water flow sensor
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "DigitalPin.h"
+
+/**
+ * @brief Counts the pulses of a flow sensor and converts them to a flow rate and the volume that has passed.
+ * The pin interrupt only increments a counter and records the time of the pulse, so pulse rates of hundreds of Hz cost
+ * the main loop nothing. Each update takes a snapshot of the counter and estimates the frequency from whole pulse
+ * periods between snapshots. The newest snapshot at least FLOW_MIN_PULSES pulses back is used, or the oldest of the
+ * last FLOW_WINDOW updates, so fast flows react within one update and slow flows are averaged over a longer window.
+ * When pulses stop the rate decays towards 0 with the time since the last pulse.
+ *
+ * The K-factor is the number of pulses per litre, the flow rate is in litres per minute.
+ */
+class FlowMeter : public DigitalPin
+{
+  public:
+    enum FlowSlot {
+      RateSlot,           // litres per minute
+      VolumeSlot,         // litres since the device started
+      FrequencySlot,      // pulses per second
+      FlowSlots
+    };
+
+    FlowMeter(short id, int pin, float _kFactor=FLOW_K_FACTOR, unsigned long _updateInterval=1000);
+
+    virtual const char* getDriverName() const;
+
+    virtual void begin();
+    virtual void handleUpdate();
+
+    inline float getKFactor() const { return kFactor; }
+    void setKFactor(float k);
+
+    /// @brief the pulses counted since the device started
+    unsigned long getPulses() const;
+
+    /// @brief the estimated pulse frequency in Hz as of the last update
+    inline float getFrequency() const { return frequency; }
+
+  protected:
+    float kFactor;
+    float frequency;
+
+    /// @brief written only by the interrupt, the update reads them without disabling interrupts
+    /// @{
+    volatile unsigned long count;
+    volatile unsigned long lastPulse;   // micros() of the last pulse
+    /// @}
+
+    // the counter as of each of the last FLOW_WINDOW updates
+    struct Snapshot {
+      unsigned long count;
+      unsigned long lastPulse;
+      unsigned long at;         // micros() when the snapshot was taken
+    };
+    Snapshot window[FLOW_WINDOW];
+    short snapshots;
+    short newest;
+
+    static void onPulse(void* arg);
+
+    // a consistent count and time of last pulse
+    Snapshot sample() const;
+
+    float estimate(const Snapshot& now) const;
+};
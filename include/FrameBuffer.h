@@ -0,0 +1,56 @@
+/**
+ * @file FrameBuffer.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Integer rasterizers drawing straight into a monochrome framebuffer in SSD1306 page layout
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+/**
+ * @brief Draws lines, rectangles and circles into a monochrome framebuffer.
+ * The buffer uses the SSD1306 page layout, each byte holds 8 vertical pixels and a page is a row of bytes covering
+ * 8 pixel rows. Vertical spans are filled a byte at a time and horizontal spans apply one mask across consecutive
+ * bytes, so filled shapes cost a fraction of drawing them pixel by pixel. Everything is clipped to the buffer.
+ * Colors are 0 (clear), 1 (set) and 2 (invert) like the SSD1306 driver. Rotation is not supported.
+ */
+class FrameBuffer
+{
+  public:
+    inline FrameBuffer(uint8_t* _buffer, short _width, short _height)
+      : buffer(_buffer), width(_width), height(_height) {}
+
+    void pixel(short x, short y, uint8_t color=1);
+
+    /// @brief horizontal line from x0 to x1 inclusive
+    void hspan(short x0, short x1, short y, uint8_t color=1);
+
+    /// @brief vertical line from y0 to y1 inclusive
+    void vspan(short x, short y0, short y1, uint8_t color=1);
+
+    /// @brief Bresenham line between two points inclusive
+    void line(short x0, short y0, short x1, short y1, uint8_t color=1);
+
+    void rect(short x, short y, short w, short h, uint8_t color=1);
+    void fillRect(short x, short y, short w, short h, uint8_t color=1);
+
+    /// @brief midpoint circle outline
+    void circle(short cx, short cy, short r, uint8_t color=1);
+    void fillCircle(short cx, short cy, short r, uint8_t color=1);
+
+  protected:
+    uint8_t* buffer;
+    short width, height;
+
+    // apply a mask of pixels to a byte
+    static inline void apply(uint8_t& b, uint8_t mask, uint8_t color) {
+      if(color == 1) b |= mask;
+      else if(color == 0) b &= ~mask;
+      else b ^= mask;
+    }
+};
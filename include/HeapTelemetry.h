@@ -0,0 +1,112 @@
+/**
+ * @file HeapTelemetry.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Heap usage and fragmentation over time, with allocations attributed to subsystems
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+class JsonStream;
+
+/// @brief The subsystems allocations are attributed to
+typedef enum {
+  HeapUntagged,
+  HeapWeb,          // web server requests and pages
+  HeapJson,         // Json documents and streams
+  HeapDevices,      // device updates
+  HeapAliases,      // alias files and lookups
+  HeapDisplay,
+  HeapInflux,
+  HeapTagCount
+} HeapTag;
+
+const char* HeapTagName(HeapTag tag);
+
+/**
+ * @brief Tracks what is allocated on the heap and by whom.
+ * The free heap, the largest free block and the fragmentation are sampled periodically by handle() so slow
+ * fragmentation from String churn can be seen long before an allocation fails.
+ *
+ * When built with HEAP_TELEMETRY every malloc, calloc, realloc and free is counted, including those of String and
+ * operator new. Each block carries a small header recording its size and the tag that was current when it was
+ * allocated, set with HEAP_SCOPE(). The live bytes and peak of each tag then show which subsystem holds the memory,
+ * and live bytes that keep growing point at a leak. A block keeps its tag when it is resized.
+ *
+ * On the ESP8266 the allocator is wrapped by linking with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+ * (see the nodemcuv2-heap environment). The host build hooks its allocator the same way as its heap counters.
+ */
+namespace HeapTelemetry {
+
+  /// @brief Allocation counts of one tag
+  struct TagCounters {
+    unsigned long allocations;
+    unsigned long frees;
+    long liveBlocks;
+    long liveBytes;
+    long peakBytes;
+  };
+
+  /// @brief A sample of the heap state
+  struct Sample {
+    unsigned long timestamp;
+    uint32_t free;
+    uint32_t largestBlock;
+    uint8_t fragmentation;     // percent
+    long liveBytes;            // bytes allocated through the wrapped allocator, 0 without HEAP_TELEMETRY
+  };
+
+  /// @brief true if allocations are counted and tagged
+  bool enabled();
+
+  /// @brief The tag new allocations are attributed to
+  HeapTag currentTag();
+  HeapTag setTag(HeapTag tag);
+
+  const TagCounters& counters(HeapTag tag);
+
+  /// @brief The heap state right now
+  Sample sample();
+
+  /// @brief Record a sample of the history when the sample interval has passed, call from loop()
+  void handle();
+
+  /// @brief Write the current heap state, the counters of each tag and the history as members of the currently open
+  /// object of a Json stream
+  void toJson(JsonStream& json);
+
+  /// @name Allocator hooks
+  /// Used by the allocator wrappers of each platform. A block is allocated HeaderSize bytes larger than requested,
+  /// track() fills in the header and returns the pointer handed to the program, untrack() takes that pointer back and
+  /// returns the allocated block, or NULL if the block was not allocated through track().
+  /// @{
+  static const size_t HeaderSize = 8;
+  void* track(void* block, size_t size, HeapTag tag);
+  void* untrack(void* ptr, size_t* size=NULL, HeapTag* tag=NULL);
+  /// @}
+}
+
+/**
+ * @brief Attributes allocations made while it is in scope to a tag, the previous tag is restored when it goes out of
+ * scope so scopes can nest.
+ */
+class HeapScope
+{
+  public:
+    inline HeapScope(HeapTag tag) : previous(HeapTelemetry::setTag(tag)) {}
+    inline ~HeapScope() { HeapTelemetry::setTag(previous); }
+
+  protected:
+    HeapTag previous;
+};
+
+#if defined(HEAP_TELEMETRY)
+#define HEAP_SCOPE(tag)   HeapScope _heapScope(tag)
+#else
+#define HEAP_SCOPE(tag)
+#endif
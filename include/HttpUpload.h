@@ -0,0 +1,112 @@
+/**
+ * @file HttpUpload.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief HTTP POST that proceeds a step at a time from the main loop
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+/**
+ * @brief Posts a payload to a fixed url without blocking the main loop.
+ * HTTPClient waits for the whole exchange, so a slow or unreachable server stalls sampling and the web server for up
+ * to its timeout. An upload instead moves through connecting, sending and receiving the status line, doing only what
+ * the connection can take without waiting on each call to handle(). Every step has a deadline and the upload fails if
+ * the step does not finish in time.
+ *
+ * After a failure no upload can be started until a backoff delay passes. The delay doubles with every consecutive
+ * failure up to a maximum and returns to the minimum after a success, so an unreachable server costs one attempt
+ * per backoff period instead of one per upload.
+ *
+ * Connecting is the one step WiFiClient performs synchronously, it is bounded by the connect timeout.
+ */
+class HttpUpload
+{
+  public:
+    typedef enum {
+      Idle,
+      Connecting,
+      Sending,
+      Receiving
+    } State;
+
+    HttpUpload();
+
+    /// @brief Set the url uploads are posted to, such as http://192.168.1.5:8086/write?db=nimble
+    /// @return false if the url is not a valid http url
+    bool begin(const char* url, const char* contentType="text/plain");
+
+    /// @brief Start posting a payload, the payload must stay unchanged until the upload finishes
+    /// @return false if an upload is in progress or the backoff delay has not passed
+    bool start(const uint8_t* payload, size_t length);
+
+    /// @brief Make progress on the upload in progress, call from loop()
+    /// @return 0 while the upload is in progress or there is none, when the upload finishes the HTTP status or a
+    /// negative HTTPC_ERROR code is returned once
+    int handle();
+
+    /// @brief Abandon the upload in progress, it does not count as a failure
+    void abort();
+
+    /// @brief true if start() would accept a payload
+    bool ready() const;
+
+    inline State getState() const { return state; }
+    inline bool busy() const { return state != Idle; }
+
+    /// @brief milliseconds until the backoff delay has passed, 0 if an upload may start
+    unsigned long backoffRemaining() const;
+
+    /// @brief Set the time each step may take, the connect timeout also bounds the one blocking call
+    void setTimeouts(unsigned long connectMs, unsigned long stepMs);
+
+    /// @brief Set the range of the backoff delay after failures
+    void setBackoff(unsigned long minMs, unsigned long maxMs);
+
+  protected:
+    WiFiClient client;
+    State state;
+
+    char host[64];
+    uint16_t port;
+    String path;
+    const char* contentType;
+
+    // request header, written before the payload
+    char header[256];
+    size_t headerLength;
+
+    const uint8_t* payload;
+    size_t length;
+    size_t sent;            // bytes of header and then payload written
+
+    // the status line of the response, only the start is kept
+    char statusLine[16];
+    short statusLength;
+
+    unsigned long connectTimeout;
+    unsigned long stepTimeout;
+    unsigned long deadline;       // millis() by which the current step must finish
+
+    unsigned long backoffMin, backoffMax;
+    unsigned long backoff;        // delay applied after the next failure
+    unsigned long retryAt;        // millis() when uploads may start again
+    bool backingOff;
+
+    // write as much of the header and payload as the connection takes
+    int send();
+
+    // read the status line, returns the status once it is complete
+    int receive();
+
+    int finish(int status);
+
+    // do not allow copying
+    HttpUpload(const HttpUpload& copy) = delete;
+    HttpUpload& operator=(const HttpUpload& copy) = delete;
+};
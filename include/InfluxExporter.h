@@ -0,0 +1,138 @@
+/**
+ * @file InfluxExporter.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Sends device readings to an InfluxDB server in batches of line protocol
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+#include "SensorReading.h"
+#include "HttpUpload.h"
+
+#include <NTPClient.h>
+
+class Devices;
+class Device;
+
+/**
+ * @brief Collects new readings from the device manager and posts them to InfluxDB.
+ * Readings are written as line protocol into batches of a fixed size, each batch holding as many points as fit. The
+ * batches live in a ring allocated once by begin(), so collecting readings does not allocate. Queued batches are posted
+ * oldest first by an HttpUpload a step at a time from handle(), so a slow or unreachable server does not stall the
+ * main loop. While the server is unreachable the ring keeps the newest batches and drops the oldest, the ring should
+ * therefore hold at least the points of one export interval. A batch being uploaded is never dropped. A batch the
+ * server rejects with a 4xx status other than 408 or 429 is dropped rather than retried, since it would fail again.
+ *
+ * Each point is tagged with the site name, the device and slot (their aliases if set, otherwise their ids) and the
+ * sensor type. Points are timestamped in milliseconds since the epoch, so nothing is exported until NTP time is known.
+ */
+class InfluxExporter
+{
+  public:
+    /// @brief Counts of what was exported and lost
+    struct Statistics {
+      unsigned long points;       // points written into batches
+      unsigned long posts;        // batches posted successfully
+      unsigned long failures;     // posts that failed
+      unsigned long dropped;      // batches dropped from a full ring or rejected by the server
+      unsigned long droppedPoints;
+      int lastStatus;             // HTTP status or HTTPC_ERROR code of the last post
+
+      inline Statistics() : points(0), posts(0), failures(0), dropped(0), droppedPoints(0), lastStatus(0) {}
+    };
+
+    InfluxExporter(Devices& manager, NTPClient& ntp);
+    ~InfluxExporter();
+
+    /// @brief Set the server and allocate the batches
+    /// @param server base url of the server such as http://192.168.1.5, the default port 8086 is added if none given
+    /// @param database database the points are written to
+    /// @param measurement measurement name of every point
+    /// @param site value of the site tag, typically the hostname
+    /// @param batchSize bytes of line protocol per post
+    /// @param depth number of batches kept while the server is unreachable, at least 2
+    /// @return false if the batches could not be allocated
+    bool begin(const char* server, const char* database, const char* measurement, const char* site,
+               unsigned short batchSize=INFLUX_BATCH_SIZE, unsigned short depth=INFLUX_QUEUE_DEPTH);
+
+    /// @brief Collect readings when the export interval has passed and make progress posting batches, call from loop()
+    void handle();
+
+    /// @brief Write every reading taken since the last collect into batches
+    /// @return the number of points written
+    unsigned int collect();
+
+    /// @brief Queue the partly filled batch so it is posted without waiting for more points
+    void flush();
+
+    /// @brief number of batches waiting to be posted, including a partly filled batch
+    unsigned short pending() const;
+
+    inline void setInterval(unsigned long ms) { interval = ms; }
+    inline unsigned long getInterval() const { return interval; }
+
+    inline const Statistics& getStatistics() const { return statistics; }
+
+    /// @brief the upload of the batches, its timeouts and backoff can be adjusted
+    inline HttpUpload& getUpload() { return upload; }
+
+  protected:
+    Devices& manager;
+    NTPClient& ntp;
+
+    HttpUpload upload;
+    bool inFlight;              // the oldest queued batch is being uploaded
+    const char* measurement;
+    const char* site;
+
+    /// @brief Ring of batches
+    /// Batch i occupies batchSize bytes at buffer + i * batchSize. The ring holds the batch at each position, the queued
+    /// batches start at position first and the batch after them is being filled. A batch is queued once the next point
+    /// does not fit.
+    /// @{
+    char* buffer;
+    unsigned short batchSize;
+    unsigned short depth;
+    unsigned short* order;      // batch at each position of the ring
+    unsigned short* lengths;    // bytes used in each batch
+    unsigned short* points;     // points in each batch
+    unsigned short first;
+    unsigned short queued;
+    /// @}
+
+    unsigned long interval;
+    unsigned long nextExport;   // millis() when handle() next collects
+    unsigned long collected;    // millis() of the last collect, readings from here on are exported next
+
+    Statistics statistics;
+
+    // the batch at a position counting from the oldest queued batch
+    inline unsigned short at(unsigned short pos) const { return order[(first + pos) % depth]; }
+
+    // the batch being filled
+    inline unsigned short filling() const { return at(queued); }
+
+    // write a point into the batch being filled, queuing it first if the point does not fit
+    bool write(const Device& device, unsigned short slot, const SensorReading& r, unsigned long long epochMs);
+
+    // write a point into buf, returns the length or 0 if it does not fit in n bytes
+    size_t formatPoint(char* buf, size_t n, const Device& device, unsigned short slot, const SensorReading& r,
+                       unsigned long long epochMs) const;
+
+    // queue the batch being filled, if the ring is full the oldest batch not being uploaded is dropped to make room
+    void queue();
+
+    // remove the oldest batch from the queue
+    void discard();
+
+    void release();
+
+    // do not allow copying
+    InfluxExporter(const InfluxExporter& copy) = delete;
+    InfluxExporter& operator=(const InfluxExporter& copy) = delete;
+};
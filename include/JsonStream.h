@@ -0,0 +1,132 @@
+/**
+ * @file JsonStream.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Writes Json text directly to an output such as a chunked Http response
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+#include "ChunkedResponse.h"
+
+// bytes of Json text collected before it is written to the output
+#if !defined(JSON_STREAM_BUFFER)
+#define JSON_STREAM_BUFFER    256
+#endif
+
+// maximum nesting of objects and arrays
+#define JSON_STREAM_DEPTH     32
+
+/**
+ * @brief Serializes Json as it is produced instead of building a document in memory first.
+ * Output is collected in a small fixed buffer and handed to the derived class whenever it fills, so memory use is
+ * constant no matter how large the Json output is. Commas and separators are inserted automatically.
+ *
+ * Example:
+ *    json.beginObject();
+ *    json.member("id", 5);
+ *    json.beginArray("slots");
+ *    json.value(72.5f);
+ *    json.endArray();
+ *    json.endObject();
+ */
+class JsonStream
+{
+  public:
+    JsonStream();
+    virtual ~JsonStream() {}
+
+    /// @brief Begin an object, as a member of the enclosing object if key is given
+    void beginObject(const char* key=NULL);
+    void endObject();
+
+    /// @brief Begin an array, as a member of the enclosing object if key is given
+    void beginArray(const char* key=NULL);
+    void endArray();
+
+    /// @brief Write the key of the next member of the enclosing object
+    void key(const char* k);
+
+    /// @name Values
+    /// Write a value, as an element of the enclosing array or as the value of the last key
+    /// @{
+    void value(const char* s);          // NULL writes null
+    void value(const String& s);
+    void value(int v);
+    void value(unsigned int v);
+    void value(long v);
+    void value(unsigned long v);
+    void value(float v);                // NaN writes null
+    void value(double v);
+    void value(bool v);
+    void null();
+    /// @}
+
+    /// @brief Write a key and value pair
+    template<class T> inline void member(const char* k, T v) { key(k); value(v); }
+
+    /// @brief Write any buffered text to the output
+    void flush();
+
+    /// @brief Total bytes of Json text produced so far
+    inline size_t bytesWritten() const { return total + length; }
+
+  protected:
+    /// @brief Write a block of Json text to the output
+    virtual void write(const char* text, size_t n) = 0;
+
+    void put(char c);
+    void put(const char* s, size_t n);
+    void putString(const char* s);
+    void putNumber(long long v);
+    void separate();
+    void open(char c, const char* key);
+    void close(char c);
+
+  private:
+    char buffer[JSON_STREAM_BUFFER];
+    size_t length;            // bytes held in buffer
+    size_t total;             // bytes written to the output
+    uint32_t hasMembers;      // bit per depth, set once the container at that depth holds a value
+    uint8_t depth;
+    bool afterKey;            // a key was written, the next value follows without a separator
+};
+
+/**
+ * @brief Streams Json into a chunked Http response.
+ * The response headers are sent when the stream is created and the response is completed by end(). The text is sent
+ * through a ChunkedResponse. Request handlers using this stream should return HTTP_RESPONSE_SENT.
+ */
+class HttpJsonStream : public JsonStream
+{
+  public:
+    HttpJsonStream(ESP8266WebServer& server, int code=200);
+    virtual ~HttpJsonStream();
+
+    /// @brief flush and complete the response
+    void end();
+
+  protected:
+    ChunkedResponse response;
+
+    virtual void write(const char* text, size_t n);
+};
+
+/**
+ * @brief Streams Json to any Print output such as Serial or a File.
+ */
+class PrintJsonStream : public JsonStream
+{
+  public:
+    inline PrintJsonStream(Print& _out) : out(_out) {}
+    virtual ~PrintJsonStream() { flush(); }
+
+  protected:
+    Print& out;
+
+    virtual void write(const char* text, size_t n);
+};
@@ -0,0 +1,70 @@
+/**
+ * @file LatencyHistogram.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Fixed size log-linear histogram of durations
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+class JsonStream;
+
+// each power of two is split into 1<<LATENCY_SUB_BITS buckets, a value is known to within 25%
+#define LATENCY_SUB_BITS    2
+
+// values from 0 up to 2^26 (67 seconds in microseconds) get their own bucket, larger values share the last bucket
+#define LATENCY_BUCKETS     (((26 - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS))
+
+/**
+ * @brief Records the distribution of a duration such as the time a device takes to update.
+ * Small values are counted exactly and larger values in buckets whose width grows with the value, so the histogram
+ * covers microseconds to minutes in a few hundred bytes at a constant relative precision. Adding a value is a few
+ * instructions and never allocates. Minimum, maximum and mean are exact, percentiles are the upper bound of the
+ * bucket they fall in.
+ *
+ * When a bucket count would overflow every bucket is halved, which keeps the shape of the distribution while giving
+ * recent values more weight.
+ */
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram();
+
+    /// @brief Record a value
+    void add(unsigned long value);
+
+    /// @brief Forget all values
+    void clear();
+
+    /// @brief number of values recorded
+    inline unsigned long count() const { return n; }
+
+    inline unsigned long min() const { return n ? lo : 0; }
+    inline unsigned long max() const { return hi; }
+    inline unsigned long mean() const { return n ? (unsigned long)(sum / n) : 0; }
+
+    /// @brief The value below which the given fraction of values fall, such as 0.99 for the 99th percentile
+    unsigned long percentile(float fraction) const;
+
+    /// @brief Add count, min, max, mean, p50 and p99 to a JsonObject
+    void toJson(JsonObject& target) const;
+
+    /// @brief Write count, min, max, mean, p50 and p99 as members of the currently open object of a Json stream
+    void toJson(JsonStream& json) const;
+
+  protected:
+    unsigned long n;
+    unsigned long lo, hi;
+    unsigned long long sum;
+    unsigned short buckets[LATENCY_BUCKETS];
+
+    static unsigned short bucketOf(unsigned long value);
+
+    // the largest value that falls in a bucket
+    static unsigned long bucketLimit(unsigned short bucket);
+};
@@ -31,6 +31,81 @@
 
 #define MAX_SLOTS     256
 
+// default capacity of the device manager, the host build raises this to profile large fleets
+#if !defined(MAX_DEVICES)
+#define MAX_DEVICES   32
+#endif
+
+// microseconds Devices::handleUpdate() may spend updating due devices in one call
+#if !defined(DEFAULT_UPDATE_BUDGET)
+#define DEFAULT_UPDATE_BUDGET   10000
+#endif
+
+// bytes of reading history each device keeps by default, 0 disables history (see Device::setHistoryBudget)
+#if !defined(DEFAULT_HISTORY_BUDGET)
+#define DEFAULT_HISTORY_BUDGET  0
+#endif
+
+// bytes of line protocol InfluxExporter sends per post, and the number of batches it keeps while the server is down
+#if !defined(INFLUX_BATCH_SIZE)
+#define INFLUX_BATCH_SIZE       1024
+#endif
+#if !defined(INFLUX_QUEUE_DEPTH)
+#define INFLUX_QUEUE_DEPTH      4
+#endif
+
+// milliseconds between InfluxExporter collecting and posting readings
+#if !defined(INFLUX_INTERVAL)
+#define INFLUX_INTERVAL         60000
+#endif
+
+// milliseconds HttpUpload allows for connecting and for each later step, and the range of its backoff after failures
+#if !defined(HTTP_UPLOAD_CONNECT_TIMEOUT)
+#define HTTP_UPLOAD_CONNECT_TIMEOUT   1000
+#endif
+#if !defined(HTTP_UPLOAD_STEP_TIMEOUT)
+#define HTTP_UPLOAD_STEP_TIMEOUT      5000
+#endif
+#if !defined(HTTP_UPLOAD_BACKOFF_MIN)
+#define HTTP_UPLOAD_BACKOFF_MIN       5000
+#endif
+#if !defined(HTTP_UPLOAD_BACKOFF_MAX)
+#define HTTP_UPLOAD_BACKOFF_MAX       600000
+#endif
+
+// edges a DigitalPin capturing edges can queue between updates, a power of two
+#if !defined(DIGITAL_EDGE_QUEUE)
+#define DIGITAL_EDGE_QUEUE      32
+#endif
+
+// pulses per litre of a FlowMeter (a YF-S201 hall effect sensor gives 450), the number of updates its frequency is
+// averaged over at most, and the pulses it averages over at least when the window allows
+#if !defined(FLOW_K_FACTOR)
+#define FLOW_K_FACTOR           450.0f
+#endif
+#if !defined(FLOW_WINDOW)
+#define FLOW_WINDOW             8
+#endif
+#if !defined(FLOW_MIN_PULSES)
+#define FLOW_MIN_PULSES         20
+#endif
+
+// bytes of the arena that holds memory of the web request being answered (see RequestArena)
+#if !defined(REQUEST_ARENA_SIZE)
+#define REQUEST_ARENA_SIZE      2048
+#endif
+
+// milliseconds between samples of the heap history and the number of samples kept (see HeapTelemetry)
+#if !defined(HEAP_SAMPLE_INTERVAL)
+#define HEAP_SAMPLE_INTERVAL    10000
+#endif
+#if !defined(HEAP_SAMPLES)
+#define HEAP_SAMPLES            60
+#endif
+
+// time must be greater than this to be considered NTP valid time
+#define TIMESTAMP_MIN           1500000000
+
 class Device;
 class Devices;
 class SensorReading;
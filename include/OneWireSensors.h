@@ -6,32 +6,80 @@
 
 #include <ArduinoJson.h>
 
-// Dallas 1wire temperature sensor resolution
+// default Dallas 1wire temperature sensor resolution (9 to 12 bits), can be set per bus
+// conversion takes 94ms at 9 bits up to 750ms at 12 bits
+#if !defined(SENSOR_RESOLUTION)
 #define SENSOR_RESOLUTION 9
+#endif
 
 #include <OneWire.h>
 #include <DallasTemperature.h>
 
+/**
+ * @brief A OneWire bus of Dallas DS18B20 temperature probes.
+ * Each probe is pinned to a slot by its ROM address. The address table is saved to SPIFFS so a probe keeps its slot,
+ * and therefor its alias, across reboots even when probes are added or removed. The bus is only searched when the
+ * table is first built, when a probe fails to respond or when a rescan is requested.
+ */
 class OneWireSensor : public Device
 {
   public:
-    OneWireSensor(short id, int _pin);
+    OneWireSensor(short id, int _pin, uint8_t _resolution=SENSOR_RESOLUTION);
     OneWireSensor(const OneWireSensor& copy);
+    virtual ~OneWireSensor();
     OneWireSensor& operator=(const OneWireSensor& copy);
 
     virtual const char* getDriverName() const;
 
     virtual void begin();
+
+    /// @brief Forget all pinned probe addresses and rebuild the table from a new bus search
+    virtual void reset();
   
+    /// @brief Starts a temperature conversion on all probes, then reads them once the conversion time has passed
+    /// The conversion is not waited on, the device schedules its own read using Device::delay().
     virtual void handleUpdate();
 
+    /// @brief Set the resolution of all probes on this bus (9 to 12 bits)
+    /// Higher resolution gives a finer temperature step but a longer conversion time.
+    void setResolution(uint8_t _resolution);
+    inline uint8_t getResolution() const { return resolution; }
+
+    /// @brief Search the bus and pin any newly found probe to a free slot
+    /// Probes that are missing keep their slot so aliases stay with the right probe when it returns.
+    /// @returns the number of probes found on the bus
+    int rescan();
+
+    /// @brief Return the slot the probe with the given ROM address is pinned to, or -1
+    short findProbe(const DeviceAddress addr) const;
+
   public:
     int pin;
     OneWire oneWire;
     DallasTemperature DS18B20;
 
   protected:
+    uint8_t resolution;         /// probe resolution in bits
+    bool converting;            /// a conversion was started and the probes are read on the next update
+    unsigned long conversionStarted;
+
+    DeviceAddress* probes;      /// ROM address pinned to each slot, all zero if the slot is free
+    bool rescanNeeded;          /// search the bus before the next conversion
+
+    /// @brief Grow the probe table to n entries, the added entries are free
+    /// @returns false if out of memory, the table is then unchanged
+    bool growProbes(short n);
+
+    short pinProbe(const DeviceAddress addr);
+    String probesFilename() const;
+    bool loadProbes();
+    bool saveProbes() const;
+
+    void startConversion();
+    void readProbes();
+
     int httpDevices(RestRequest& request);
+    int httpRescan(RestRequest& request);
     
     void getDeviceInfo(JsonObject& node);
 };
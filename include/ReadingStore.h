@@ -0,0 +1,110 @@
+/**
+ * @file ReadingStore.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Columnar copy of the current readings of all devices
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+#include "SensorReading.h"
+
+class Device;
+
+/**
+ * @brief Holds the current reading of every slot of every device as parallel arrays.
+ * Each slot is a row, the rows of a device are consecutive and devices follow each other in the order of the device
+ * manager's device table. Sensor type, value type, timestamp and value are each kept in their own array so a scan
+ * filtering on type or time only reads the packed column it filters on instead of every reading of every device.
+ *
+ * Devices keep writing their readings through Device::operator[], which marks the device as changed. The device
+ * manager copies the slots of changed devices into the store when an iteration starts, so a device updated many
+ * times between scans is only copied once.
+ */
+class ReadingStore
+{
+  public:
+    ReadingStore();
+    ~ReadingStore();
+
+    /// @brief Assign rows to every device and publish all their readings
+    /// Called when devices are added or removed or a device changed its number of slots.
+    /// @param devices the device table, entries may be NULL
+    /// @param ndevices size of the device table
+    void layout(Device** devices, short ndevices);
+
+    /// @brief Copy the current readings of a device into its rows
+    /// @param ordinal position of the device in the device table
+    /// @return false if the device's slot count no longer matches its rows and the store must be laid out again
+    bool publish(short ordinal, const Device& device);
+
+    /// @brief Find the first row from row up to end with a valid reading of the given type and value type
+    /// that was taken at or after tsFrom. Invalid and 0 match any sensor and value type.
+    /// A sensor type filter only visits the rows listed for that type, or searches the type column if the type is
+    /// common enough that walking its list would be slower.
+    /// @param cursor position in the list of rows of the type, kept by the caller between calls, start it at 0
+    /// @return the row or end if none match
+    inline unsigned int scan(unsigned int row, unsigned int end, SensorType st, char vt, unsigned long tsFrom, unsigned int& cursor) {
+      if(end > nrows)
+        end = nrows;
+      if(st != Invalid)
+        return scanType(row, end, st, vt, tsFrom, cursor);
+      for(; row < end; row++)
+        if(sensorTypes[row] != Invalid && accepts(row, vt, tsFrom))
+          return row;
+      return end;
+    }
+
+    /// @brief The reading held in a row
+    inline SensorReading get(unsigned int row) const {
+      return SensorReading((SensorType)sensorTypes[row], valueTypes[row], timestamps[row], values[row]);
+    }
+
+    /// @brief total number of rows
+    inline unsigned int rows() const { return nrows; }
+
+    /// @brief first row of a device, rows of a device run from first(ordinal) to first(ordinal+1)
+    inline unsigned int first(short ordinal) const { return (ordinal < nbase) ? base[ordinal] : nrows; }
+
+  protected:
+    // columns, one element per row
+    uint8_t* sensorTypes;
+    char* valueTypes;
+    unsigned long* timestamps;
+    long* values;               // bits of the reading's value union
+    unsigned int nrows;
+
+    /// @brief Rows grouped by sensor type
+    /// typeRows lists the rows of each type in row order, the rows of type t start at typeStart[t] and end at
+    /// typeStart[t+1]. A row whose reading turns invalid stays listed under its type, the type column is checked on
+    /// every lookup. The index is rebuilt on the next lookup after a row takes a type it is not listed under.
+    /// @{
+    uint8_t* indexedTypes;      // the type each row is listed under, Invalid if not listed
+    unsigned int* typeRows;
+    unsigned int typeStart[LastSensorType + 2];
+    bool indexStale;
+    /// @}
+
+    // first row of each device in the device table, followed by the total row count
+    unsigned int* base;
+    short nbase;
+
+    void release();
+    void releaseColumns();
+
+    // the filters on everything but the sensor type
+    inline bool accepts(unsigned int row, char vt, unsigned long tsFrom) const {
+      return valueTypes[row] != VT_INVALID && (vt == 0 || valueTypes[row] == vt) && timestamps[row] >= tsFrom;
+    }
+
+    unsigned int scanType(unsigned int row, unsigned int end, SensorType st, char vt, unsigned long tsFrom, unsigned int& cursor);
+    void buildIndex();
+
+    // do not allow copying
+    ReadingStore(const ReadingStore& copy) = delete;
+    ReadingStore& operator=(const ReadingStore& copy) = delete;
+};
@@ -0,0 +1,103 @@
+/**
+ * @file RequestArena.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Bump allocator for memory that only lives until the current web request is answered
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+
+/**
+ * @brief Hands out memory for the duration of one web request from a single block that is kept for the life of the
+ * program. An allocation only moves a pointer and nothing is freed individually, the whole arena is reset once the
+ * response has been sent. Text built while answering a request such as replies and alias listings therefore never
+ * touches the general heap and cannot fragment it.
+ *
+ * The block is allocated on first use. Allocations that do not fit are taken from the heap and released by the next
+ * reset, overflows() counts them so REQUEST_ARENA_SIZE can be tuned.
+ *
+ * Memory from the arena must not be kept beyond the request, such as in a device alias or a Json document that
+ * outlives the response. Text given to the Json response of a RestRequest as const char* is stored by reference and
+ * stays valid until the response is sent.
+ */
+class RequestArena
+{
+  public:
+    RequestArena(size_t capacity=REQUEST_ARENA_SIZE);
+    ~RequestArena();
+
+    /// @brief Allocate n bytes aligned for any type
+    /// @return the memory, or NULL only if the heap is exhausted as well
+    void* allocate(size_t n);
+
+    /// @brief Resize an allocation, the last allocation grows in place while it fits
+    void* reallocate(void* ptr, size_t n);
+
+    /// @brief Copy a string into the arena
+    char* strdup(const char* s);
+
+    /// @brief printf into the arena
+    char* format(const char* fmt, ...) __attribute__ ((format (printf, 2, 3)));
+
+    /// @brief Release everything allocated since the last reset, the block is kept for the next request
+    void reset();
+
+    inline size_t capacity() const { return size; }
+    inline size_t used() const { return top; }
+
+    /// @brief the most bytes used by any request, including allocations that overflowed to the heap
+    inline size_t highWater() const { return peak; }
+
+    /// @brief number of allocations that did not fit and were taken from the heap
+    inline unsigned long overflows() const { return misses; }
+
+    /**
+     * @brief Collects printed text in the arena, the text is always terminated.
+     * The text is the last allocation of the arena while it is being written so it grows in place, make no other
+     * allocations from the arena until it is complete.
+     */
+    class Text : public Print
+    {
+      public:
+        Text(RequestArena& arena);
+
+        virtual size_t write(uint8_t c);
+        virtual size_t write(const uint8_t *buffer, size_t n);
+        using Print::write;
+
+        inline const char* c_str() const { return text ? text : ""; }
+        inline size_t length() const { return len; }
+
+      protected:
+        RequestArena& arena;
+        char* text;
+        size_t len;
+        size_t room;
+    };
+
+  protected:
+    // an allocation that did not fit in the block
+    struct Overflow {
+      Overflow* next;
+      size_t size;
+    };
+
+    uint8_t* block;
+    size_t size;
+    size_t top;         // offset of the next allocation
+    size_t last;        // offset of the last allocation, where it can grow in place
+    size_t spilled;     // bytes taken from the heap since the last reset
+    size_t peak;
+    unsigned long misses;
+    Overflow* overflow;
+
+    size_t sizeOf(const void* ptr) const;
+};
+
+/// @brief The arena of the web request being handled, reset by loop() after each call to the web server
+extern RequestArena RequestScratch;
@@ -13,6 +13,8 @@
 
 #include "NimbleConfig.h"
 
+class JsonStream;
+
 
 #define F_BIT(x) (1<<x)
 
@@ -45,8 +47,23 @@ class SensorAddress {
     inline bool operator>(const SensorAddress& sa) const { return (sa.device==device) ? sa.slot>slot : sa.device>device; }
 
     String toString() const;
+
+    /// @brief Write the address as device:slot text into buf, the same text as toString() without allocating
+    /// @return the length of the text, which is truncated to fit n-1 characters
+    size_t formatTo(char* buf, size_t n) const;
 };
 
+// room for the text of any reading or address formatted by formatTo()
+#define READING_TEXT_SIZE   24
+
+/**
+ * @brief Write a float as decimal text with a fixed number of decimals without allocating.
+ * The text matches Print::print(float, precision), nan, inf or ovf for values that cannot be shown, except that a value
+ * exactly halfway between two decimals always rounds away from zero.
+ * @return the length of the text, which is truncated to fit n-1 characters
+ */
+size_t formatDecimal(char* buf, size_t n, float value, uint8_t precision=2);
+
 /**
  * @brief Holds sensor readings of any primitive type such as integers, strings, reals and more.
  * 
@@ -85,6 +102,24 @@ class SensorReading
      */
     String toString() const;
 
+    /**
+     * @brief Write the reading as text into a buffer, the same text as toString() but without allocating
+     * A buffer of READING_TEXT_SIZE holds any reading.
+     *
+     * @param buf receives the text, it is always terminated
+     * @param n size of buf
+     * @param precision decimals of a float reading
+     * @return the length of the text, which is truncated to fit n-1 characters
+     */
+    size_t formatTo(char* buf, size_t n, uint8_t precision=2) const;
+
+    /**
+     * @brief Print the reading as text, the same text as toString() but without building a String
+     * 
+     * @return the number of characters printed
+     */
+    size_t printTo(Print& out) const;
+
     /**
      * @brief Converts the sensor reading to a Json object
      * 
@@ -101,9 +136,16 @@ class SensorReading
      */
     void addTo(JsonArray& array) const;
 
+    /// @brief Write the details of the reading as members of the currently open object of a Json stream
+    void toJson(JsonStream& json, bool showType=true, bool showTimestamp=true) const;
+
+    /// @brief Write the reading value as the next value of a Json stream
+    void addTo(JsonStream& json) const;
+
   public:
     inline SensorReading() : sensorType(Numeric), valueType(VT_CLEAR), timestamp(millis()), l(0) {}
     inline SensorReading(SensorType st, char vt, long _l) : sensorType(st), valueType(vt), timestamp(millis()), l(_l) {}
+    inline SensorReading(SensorType st, char vt, unsigned long ts, long _l) : sensorType(st), valueType(vt), timestamp(ts), l(_l) {}
     inline SensorReading(SensorType st, float _f) : sensorType(st), valueType('f'), timestamp(millis()), f(_f) {}
     inline SensorReading(SensorType st, double _f) : sensorType(st), valueType('f'), timestamp(millis()), f((float)_f) {}
     inline SensorReading(SensorType st, long _l) : sensorType(st), valueType('l'), timestamp(millis()), l(_l) {}
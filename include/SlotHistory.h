@@ -0,0 +1,88 @@
+/**
+ * @file SlotHistory.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Fixed capacity history of the readings of a single device slot
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+#include "SensorReading.h"
+
+// timestamps are stored as deltas in units of 1<<HISTORY_TIME_SHIFT milliseconds (16ms, a delta of up to 17 minutes)
+#define HISTORY_TIME_SHIFT    4
+
+/**
+ * @brief A ring buffer of past readings of one slot in a compact encoding.
+ * Each sample takes 4 bytes instead of the 12-16 bytes of a SensorReading. The timestamp is stored as the delta from
+ * the previous sample and the value is quantized to a 16 bit integer relative to the first value recorded. The
+ * quantization step depends on the sensor type, for example 0.01 degrees for temperature. When the buffer is full the
+ * oldest sample is dropped.
+ */
+class SlotHistory
+{
+  public:
+    SlotHistory();
+    ~SlotHistory();
+
+    /// @brief Allocate room for a number of samples, any existing samples are discarded
+    bool alloc(unsigned short _capacity);
+
+    /// @brief Discard all samples
+    void clear();
+
+    /// @brief Append a reading, the reading must be newer than the last reading added
+    void add(const SensorReading& r);
+
+    inline unsigned short count() const { return n; }
+    inline unsigned short capacity() const { return size; }
+
+    /// @brief timestamp of the newest sample, or 0 if empty
+    inline unsigned long lastTimestamp() const { return n ? latest : 0; }
+
+    /// @brief bytes of sample storage held by this history
+    inline size_t memoryUsage() const { return size * sizeof(Sample); }
+
+    /**
+     * @brief Decode samples from oldest to newest.
+     * Start with pos and ts set to 0, each call decodes the sample at pos and advances it.
+     *
+     * @param pos Position of the next sample, updated on return.
+     * @param ts Timestamp of the previous sample, updated on return.
+     * @param r Receives the decoded reading.
+     * @return true if a reading was decoded, false if there are no more samples
+     */
+    bool next(unsigned short& pos, unsigned long& ts, SensorReading& r) const;
+
+    /// @brief size in bytes of one sample
+    static size_t sampleSize();
+
+  protected:
+    struct Sample {
+      uint16_t dt;        // time since previous sample in 1<<HISTORY_TIME_SHIFT ms units
+      int16_t value;      // (value - offset) / quantum, or GAP for a time-only filler sample
+    };
+
+    Sample* samples;
+    unsigned short size;          // capacity of samples
+    unsigned short head;          // position of the oldest sample
+    unsigned short n;             // number of samples held
+    unsigned long first;          // decoded timestamp of the oldest sample
+    unsigned long tail;           // decoded timestamp of the newest sample
+    unsigned long latest;         // exact timestamp of the newest sample
+    SensorType sensorType;
+    char valueType;
+    float offset;                 // value samples are relative to
+    float quantum;                // value of one step of a sample
+
+    void push(uint16_t dt, int16_t value);
+    void dropOldest();
+
+    // do not allow copying
+    SlotHistory(const SlotHistory& copy) = delete;
+    SlotHistory& operator=(const SlotHistory& copy) = delete;
+};
@@ -0,0 +1,71 @@
+/**
+ * @file TrendSeries.h
+ * @author Colin F. MacKenzie (nospam2@colinmackenzie.net)
+ * @brief Downsampled min/max/average series of the recent readings of a slot
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleConfig.h"
+#include "SensorReading.h"
+
+/**
+ * @brief Keeps the minimum, maximum and average of a slot's readings over a sliding window of time.
+ * The window is divided into a fixed number of buckets, typically one per pixel column of a graph. Readings are added
+ * as they arrive and only update the bucket covering their timestamp, older buckets scroll out of the window as time
+ * passes. Drawing the series therefore costs one step per bucket no matter how many readings were added.
+ */
+class TrendSeries
+{
+  public:
+    /// @param _deviceId device of the slot being tracked
+    /// @param _slot slot being tracked
+    /// @param _size number of buckets
+    /// @param period span of time covered by all buckets in milliseconds
+    TrendSeries(short _deviceId, short _slot, unsigned short _size, unsigned long period);
+    ~TrendSeries();
+
+    /// @brief Add a reading if it is newer than the last reading added
+    /// @return true if the series changed
+    bool add(const SensorReading& r);
+
+    /// @brief Scroll the window so the newest bucket covers the given time, buckets scrolled in are empty
+    /// @return true if the window moved
+    bool advance(unsigned long now);
+
+    /// @brief Get the statistics of a bucket, 0 is the oldest bucket in the window
+    /// @return false if no readings fell into the bucket
+    bool get(unsigned short i, float& min, float& max, float& avg) const;
+
+    /// @brief true if this series tracks the given slot with the given number of buckets and period
+    bool matches(short _deviceId, short _slot, unsigned short _size, unsigned long period) const;
+
+    /// @brief true if the series was allocated
+    inline bool isValid() const { return buckets!=NULL; }
+
+    inline unsigned short size() const { return nbuckets; }
+    inline unsigned long period() const { return bucketMs * nbuckets; }
+
+    short deviceId;
+    short slot;
+
+  protected:
+    struct Bucket {
+      float min, max, sum;
+      unsigned short count;
+    };
+
+    Bucket* buckets;
+    unsigned short nbuckets;
+    unsigned long bucketMs;       // time covered by one bucket
+    unsigned long head;           // bucket number (time / bucketMs) of the newest bucket
+    unsigned long lastTimestamp;  // timestamp of the last reading added
+
+    // do not allow copying
+    TrendSeries(const TrendSeries& copy) = delete;
+    TrendSeries& operator=(const TrendSeries& copy) = delete;
+};
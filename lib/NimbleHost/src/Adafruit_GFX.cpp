@@ -0,0 +1,246 @@
+#include "Adafruit_GFX.h"
+
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+  : WIDTH(w), HEIGHT(h), _width(w), _height(h), cursor_x(0), cursor_y(0), textcolor(0xFFFF), textbgcolor(0xFFFF),
+    textsize(1), rotation(0), wrap(true), gfxFont(NULL)
+{
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  drawLine(x, y, x, y + h - 1, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  drawLine(x, y, x + w - 1, y, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  for(int16_t i = x; i < x + w; i++)
+    drawFastVLine(i, y, h, color);
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color)
+{
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+  if(steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if(x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+
+  for(; x0 <= x1; x0++) {
+    if(steep)
+      drawPixel(y0, x0, color);
+    else
+      drawPixel(x0, y0, color);
+    err -= dy;
+    if(err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  drawPixel(x0, y0 + r, color);
+  drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color);
+  drawPixel(x0 - r, y0, color);
+
+  while(x < y) {
+    if(f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+
+    drawPixel(x0 + x, y0 + y, color);
+    drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color);
+    drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color);
+    drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color);
+    drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+void Adafruit_GFX::drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color)
+{
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  while(x < y) {
+    if(f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if(cornername & 0x4) {
+      drawPixel(x0 + x, y0 + y, color);
+      drawPixel(x0 + y, y0 + x, color);
+    }
+    if(cornername & 0x2) {
+      drawPixel(x0 + x, y0 - y, color);
+      drawPixel(x0 + y, y0 - x, color);
+    }
+    if(cornername & 0x8) {
+      drawPixel(x0 - y, y0 + x, color);
+      drawPixel(x0 - x, y0 + y, color);
+    }
+    if(cornername & 0x1) {
+      drawPixel(x0 - y, y0 - x, color);
+      drawPixel(x0 - x, y0 - y, color);
+    }
+  }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+}
+
+void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color)
+{
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  int16_t px = x;
+  int16_t py = y;
+
+  delta++;
+
+  while(x < y) {
+    if(f >= 0) {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if(x < (y + 1)) {
+      if(corners & 1)
+        drawFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+      if(corners & 2)
+        drawFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+    }
+    if(y != py) {
+      if(corners & 1)
+        drawFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+      if(corners & 2)
+        drawFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+      py = y;
+    }
+    px = x;
+  }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+  // no font bitmaps on the host, draw a 5x7 pattern derived from the character code instead
+  for(int8_t i = 0; i < 5; i++) {
+    uint8_t line = (uint8_t)((c * (i + 3)) ^ (c >> i)) & 0x7F;
+    for(int8_t j = 0; j < 8; j++, line >>= 1) {
+      if(line & 1) {
+        if(size == 1)
+          drawPixel(x + i, y + j, color);
+        else
+          fillRect(x + i * size, y + j * size, size, size, color);
+      } else if(bg != color) {
+        if(size == 1)
+          drawPixel(x + i, y + j, bg);
+        else
+          fillRect(x + i * size, y + j * size, size, size, bg);
+      }
+    }
+  }
+}
+
+void Adafruit_GFX::setFont(const GFXfont* f)
+{
+  if(f && !gfxFont)
+    cursor_y += 6;   // switching from classic to GFX font moves the cursor from top-left to baseline
+  else if(!f && gfxFont)
+    cursor_y -= 6;
+  gfxFont = f;
+}
+
+size_t Adafruit_GFX::write(uint8_t c)
+{
+  if(!gfxFont) {
+    if(c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize * 8;
+    } else if(c != '\r') {
+      if(wrap && (cursor_x + textsize * 6) > _width) {
+        cursor_x = 0;
+        cursor_y += textsize * 8;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+      cursor_x += textsize * 6;
+    }
+  } else {
+    uint8_t advance = (uint8_t)(gfxFont->yAdvance * 3 / 5);
+    if(c == '\n') {
+      cursor_x = 0;
+      cursor_y += (int16_t)textsize * gfxFont->yAdvance;
+    } else if(c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+      if(gfxFont->glyph) {
+        const GFXglyph& glyph = gfxFont->glyph[c - gfxFont->first];
+        advance = glyph.xAdvance;
+      }
+      if(wrap && (cursor_x + textsize * advance) > _width) {
+        cursor_x = 0;
+        cursor_y += (int16_t)textsize * gfxFont->yAdvance;
+      }
+      drawChar(cursor_x, cursor_y - 7 * textsize, c, textcolor, textcolor, textsize);
+      cursor_x += textsize * advance;
+    }
+  }
+  return 1;
+}
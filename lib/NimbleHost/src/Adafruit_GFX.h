@@ -0,0 +1,81 @@
+/**
+ * @file Adafruit_GFX.h
+ * @brief Host (native) stand-in for the Adafruit GFX graphics core.
+ * Geometry primitives are rasterized exactly as the Adafruit implementation does. Text is drawn as a deterministic
+ * block pattern per character since no glyph bitmaps are shipped with the host build; cursor advance matches the
+ * classic 6x8 font or the yAdvance of a GFX font.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+typedef struct {
+  uint16_t bitmapOffset;
+  uint8_t width;
+  uint8_t height;
+  uint8_t xAdvance;
+  int8_t xOffset;
+  int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+  uint8_t* bitmap;
+  GFXglyph* glyph;
+  uint16_t first;
+  uint16_t last;
+  uint8_t yAdvance;
+} GFXfont;
+
+class Adafruit_GFX : public Print
+{
+  public:
+    Adafruit_GFX(int16_t w, int16_t h);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color);
+    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+    void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+    void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+    void setTextSize(uint8_t s) { textsize = (s > 0) ? s : 1; }
+    void setTextWrap(bool w) { wrap = w; }
+    void setFont(const GFXfont* f=NULL);
+    void setRotation(uint8_t r) { rotation = r & 3; }
+
+    virtual size_t write(uint8_t c);
+    using Print::write;
+
+    inline int16_t width() const { return _width; }
+    inline int16_t height() const { return _height; }
+    inline int16_t getCursorX() const { return cursor_x; }
+    inline int16_t getCursorY() const { return cursor_y; }
+    inline uint8_t getRotation() const { return rotation; }
+
+  protected:
+    const int16_t WIDTH, HEIGHT;
+    int16_t _width, _height;
+    int16_t cursor_x, cursor_y;
+    uint16_t textcolor, textbgcolor;
+    uint8_t textsize;
+    uint8_t rotation;
+    bool wrap;
+    const GFXfont* gfxFont;
+
+    void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color);
+    void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color);
+};
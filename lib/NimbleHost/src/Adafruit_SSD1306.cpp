@@ -0,0 +1,142 @@
+#include "Adafruit_SSD1306.h"
+
+
+Adafruit_SSD1306::Adafruit_SSD1306(int8_t rst_pin)
+  : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), flushes(0), bytesSent(0), i2caddr(0x3C), commandLength(0),
+    pageStart(0), pageEnd(SSD1306_LCDHEIGHT/8 - 1), page(0), columnStart(0), columnEnd(SSD1306_LCDWIDTH - 1), column(0)
+{
+  memset(panel, 0, sizeof(panel));
+  memset(buffer, 0, sizeof(buffer));
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306()
+{
+  if(NimbleHost::findI2C(i2caddr) == this)
+    NimbleHost::detachI2C(i2caddr);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t _i2caddr, bool reset, bool periphBegin)
+{
+  i2caddr = _i2caddr;
+  NimbleHost::attachI2C(i2caddr, this);
+  // the real driver sends a 25 byte init sequence
+  bytesSent += 25;
+  return true;
+}
+
+void Adafruit_SSD1306::display()
+{
+  // page and column address commands, then the framebuffer in 16 byte data transmissions
+  const unsigned long chunks = sizeof(buffer) / 16;
+  bytesSent += 6 + sizeof(buffer) + chunks * 2;
+  Wire.bytesTransferred += 6 + sizeof(buffer) + chunks * 2;
+  Wire.transactions += chunks + 1;
+  memcpy(panel, buffer, sizeof(panel));
+  flushes++;
+
+  // the full refresh leaves the address window covering the whole panel
+  pageStart = page = 0;
+  pageEnd = SSD1306_LCDHEIGHT/8 - 1;
+  columnStart = column = 0;
+  columnEnd = SSD1306_LCDWIDTH - 1;
+}
+
+void Adafruit_SSD1306::clearDisplay()
+{
+  memset(buffer, 0, sizeof(buffer));
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i)
+{
+  ssd1306_command(i ? 0xA7 : 0xA6);
+}
+
+void Adafruit_SSD1306::dim(bool dim)
+{
+  ssd1306_command(SSD1306_SETCONTRAST);
+  ssd1306_command(dim ? 0 : 0xCF);
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c)
+{
+  // the same transmission as the real driver, a control byte then the command
+  Wire.beginTransmission(i2caddr);
+  Wire.write((uint8_t)0x00);
+  Wire.write(c);
+  Wire.endTransmission();
+}
+
+void Adafruit_SSD1306::receive(const uint8_t* data, size_t length)
+{
+  bytesSent += length;
+  if(length < 1)
+    return;
+
+  if(data[0] & 0x40) {
+    // display data, written at the address pointer which wraps within the page and column window
+    for(size_t i=1; i<length; i++) {
+      if(page < SSD1306_LCDHEIGHT/8 && column < SSD1306_LCDWIDTH)
+        panel[column + page * SSD1306_LCDWIDTH] = data[i];
+      if(column++ >= columnEnd) {
+        column = columnStart;
+        page = (page >= pageEnd) ? pageStart : page + 1;
+      }
+    }
+  } else {
+    // commands, some take argument bytes
+    for(size_t i=1; i<length; i++) {
+      command[commandLength++] = data[i];
+      uint8_t args = 0;
+      switch(command[0]) {
+        case SSD1306_COLUMNADDR:
+        case SSD1306_PAGEADDR:
+          args = 2; break;
+        case SSD1306_MEMORYMODE:
+        case SSD1306_SETCONTRAST:
+          args = 1; break;
+      }
+      if(commandLength > args)
+        execute();
+    }
+  }
+}
+
+void Adafruit_SSD1306::execute()
+{
+  switch(command[0]) {
+    case SSD1306_COLUMNADDR:
+      columnStart = column = command[1];
+      columnEnd = command[2];
+      break;
+    case SSD1306_PAGEADDR:
+      pageStart = page = command[1];
+      pageEnd = command[2];
+      break;
+  }
+  commandLength = 0;
+}
+
+size_t Adafruit_SSD1306::request(uint8_t* data, size_t length)
+{
+  return 0;   // the controller is write only over I2C
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if(x < 0 || x >= width() || y < 0 || y >= height())
+    return;
+  uint8_t& b = buffer[x + (y / 8) * SSD1306_LCDWIDTH];
+  uint8_t bit = (uint8_t)(1 << (y & 7));
+  switch(color) {
+    case WHITE: b |= bit; break;
+    case BLACK: b &= ~bit; break;
+    case INVERSE: b ^= bit; break;
+  }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const
+{
+  if(x < 0 || x >= width() || y < 0 || y >= height())
+    return false;
+  return (buffer[x + (y / 8) * SSD1306_LCDWIDTH] & (1 << (y & 7))) != 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file Adafruit_SSD1306.h
+ * @brief Host (native) stand-in for the Adafruit SSD1306 OLED driver (128x64, I2C).
+ * The framebuffer uses the same page layout as the controller, one byte covers 8 vertical pixels. Each display() call
+ * copies the framebuffer to the simulated panel and counts the I2C bytes a full refresh would move. The controller is
+ * also attached to the simulated I2C bus so commands and data written directly over Wire, such as a partial refresh
+ * of a page and column window, update the panel too.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "Adafruit_GFX.h"
+#include "NimbleHost.h"
+
+#define BLACK                 0
+#define WHITE                 1
+#define INVERSE               2
+#define SSD1306_BLACK         BLACK
+#define SSD1306_WHITE         WHITE
+#define SSD1306_INVERSE       INVERSE
+
+#define SSD1306_LCDWIDTH      128
+#define SSD1306_LCDHEIGHT     64
+
+#define SSD1306_EXTERNALVCC   0x01
+#define SSD1306_SWITCHCAPVCC  0x02
+
+#define SSD1306_MEMORYMODE    0x20
+#define SSD1306_COLUMNADDR    0x21
+#define SSD1306_PAGEADDR      0x22
+#define SSD1306_SETCONTRAST   0x81
+#define SSD1306_DISPLAYOFF    0xAE
+#define SSD1306_DISPLAYON     0xAF
+
+class Adafruit_SSD1306 : public Adafruit_GFX, public NimbleHost::I2CPeripheral
+{
+  public:
+    Adafruit_SSD1306(int8_t rst_pin=-1);
+    virtual ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc=SSD1306_SWITCHCAPVCC, uint8_t i2caddr=0x3C, bool reset=true, bool periphBegin=true);
+    void display();
+    void clearDisplay();
+    void invertDisplay(bool i);
+    void dim(bool dim);
+    void ssd1306_command(uint8_t c);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color);
+    bool getPixel(int16_t x, int16_t y) const;
+    inline uint8_t* getBuffer() { return buffer; }
+
+    /// @name Host simulation
+    /// @{
+    /// @brief what the panel currently shows, as of the last display()
+    uint8_t panel[SSD1306_LCDWIDTH * SSD1306_LCDHEIGHT / 8];
+
+    /// @brief number of display() calls
+    unsigned long flushes;
+
+    /// @brief I2C bytes sent to the controller, commands and data
+    unsigned long bytesSent;
+
+    virtual void receive(const uint8_t* data, size_t length);
+    virtual size_t request(uint8_t* data, size_t length);
+    /// @}
+
+  protected:
+    uint8_t buffer[SSD1306_LCDWIDTH * SSD1306_LCDHEIGHT / 8];
+    uint8_t i2caddr;
+
+    // controller state for writes over the bus
+    uint8_t command[3];           // command being received and its arguments
+    uint8_t commandLength;
+    uint8_t pageStart, pageEnd, page;
+    uint8_t columnStart, columnEnd, column;
+
+    void execute();
+};
@@ -0,0 +1,111 @@
+/**
+ * @file Arduino.h
+ * @brief Host (native) stand-in for the ESP8266 Arduino core.
+ * Provides just enough of the Wiring API for the Nimble core to compile and run on a workstation. Time, GPIO and
+ * peripherals are simulated and can be driven from a benchmark or test harness through NimbleHost.h.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include <algorithm>
+#include <functional>
+
+#define ARDUINO_HOST    1
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH            0x1
+#define LOW             0x0
+
+#define INPUT           0x00
+#define OUTPUT          0x01
+#define INPUT_PULLUP    0x02
+
+#define RISING          0x01
+#define FALLING         0x02
+#define CHANGE          0x03
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define LED_BUILTIN     2
+#define NUM_DIGITAL_PINS 17
+
+#define WDTO_8S         8000
+
+#define PROGMEM
+#define PGM_P           const char*
+#define F(string_literal) (string_literal)
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+
+#define digitalPinToInterrupt(p)  (((p) < NUM_DIGITAL_PINS) ? (p) : -1)
+
+using std::min;
+using std::max;
+
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+int analogRead(uint8_t pin);
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+void interrupts();
+void noInterrupts();
+
+/**
+ * @brief Stand-in for the ESP8266 system object (EspClass)
+ * Heap figures come from the host allocator and are only indicative.
+ */
+class EspClass {
+  public:
+    void wdtEnable(uint32_t timeout_ms=0);
+    void wdtDisable();
+    void wdtFeed();
+
+    void restart();
+    void reset();
+
+    uint32_t getFreeHeap();
+    uint32_t getMaxFreeBlockSize();
+    uint8_t getHeapFragmentation();
+    uint32_t getCycleCount();
+    uint8_t getCpuFreqMHz() { return 80; }
+    uint32_t getChipId() { return 0x00d1ce; }
+};
+
+extern EspClass ESP;
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+// the sketch entry points, as called by the host main()
+void setup();
+void loop();
@@ -0,0 +1,49 @@
+/**
+ * @file DHT.h
+ * @brief Host (native) stand-in for the Adafruit DHT humidity/temperature sensor library.
+ * Readings follow a slow sine wave over millis() so consumers see changing values.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define DHT11   11
+#define DHT12   12
+#define DHT22   22
+#define DHT21   21
+#define AM2301  21
+
+class DHT
+{
+  public:
+    inline DHT(uint8_t _pin, uint8_t _type, uint8_t count=6) : pin(_pin), type(_type) {}
+
+    inline void begin(uint8_t usec=55) {}
+
+    inline float readTemperature(bool S=false, bool force=false) {
+      float c = 21.0f + 2.0f * (float)sin(millis() / 600000.0 + pin);
+      return S ? convertCtoF(c) : c;
+    }
+
+    inline float readHumidity(bool force=false) {
+      return 45.0f + 5.0f * (float)sin(millis() / 900000.0 + pin);
+    }
+
+    inline float convertCtoF(float c) { return c * 1.8f + 32; }
+    inline float convertFtoC(float f) { return (f - 32) * 0.55555f; }
+
+    float computeHeatIndex(float temperature, float percentHumidity, bool isFahrenheit=true) {
+      float t = isFahrenheit ? temperature : convertCtoF(temperature);
+      float hi = 0.5f * (t + 61.0f + ((t - 68.0f) * 1.2f) + (percentHumidity * 0.094f));
+      return isFahrenheit ? hi : convertFtoC(hi);
+    }
+
+  protected:
+    uint8_t pin;
+    uint8_t type;
+};
@@ -0,0 +1,216 @@
+#include "DallasTemperature.h"
+#include "NimbleHost.h"
+
+
+namespace NimbleHost {
+
+  static uint8_t oneWireProbes[NUM_DIGITAL_PINS];
+
+  void setOneWireProbes(uint8_t pin, uint8_t count)
+  {
+    if(pin < NUM_DIGITAL_PINS)
+      oneWireProbes[pin] = count;
+  }
+
+  static uint8_t getOneWireProbes(uint8_t pin)
+  {
+    return (pin < NUM_DIGITAL_PINS) ? oneWireProbes[pin] : 0;
+  }
+}
+
+
+uint8_t OneWire::reset()
+{
+  // presence pulse if any probe is attached
+  return probeCount() > 0;
+}
+
+void OneWire::reset_search()
+{
+  searchIndex = 0;
+}
+
+bool OneWire::search(uint8_t* newAddr, bool search_mode)
+{
+  searches++;
+  if(searchIndex >= probeCount())
+    return false;
+  probeAddress(pin, searchIndex++, newAddr);
+  return true;
+}
+
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len)
+{
+  uint8_t crc = 0;
+  while(len--) {
+    uint8_t inbyte = *addr++;
+    for(uint8_t i = 8; i; i--) {
+      uint8_t mix = (crc ^ inbyte) & 0x01;
+      crc >>= 1;
+      if(mix)
+        crc ^= 0x8C;
+      inbyte >>= 1;
+    }
+  }
+  return crc;
+}
+
+uint8_t OneWire::probeCount() const
+{
+  return NimbleHost::getOneWireProbes(pin);
+}
+
+void OneWire::probeAddress(uint8_t pin, uint8_t index, uint8_t* addr)
+{
+  addr[0] = DS18B20MODEL;
+  addr[1] = index;
+  addr[2] = pin;
+  addr[3] = 0x4E;
+  addr[4] = 0x1D;
+  addr[5] = (uint8_t)(index * 37);
+  addr[6] = 0;
+  addr[7] = crc8(addr, 7);
+}
+
+
+DallasTemperature::DallasTemperature()
+  : wire(NULL), resolution(9), waitForConversion(true), conversionStarted(0), conversionComplete(0)
+{
+}
+
+DallasTemperature::DallasTemperature(OneWire* _wire)
+  : wire(_wire), resolution(9), waitForConversion(true), conversionStarted(0), conversionComplete(0)
+{
+}
+
+void DallasTemperature::begin()
+{
+}
+
+uint8_t DallasTemperature::getDeviceCount()
+{
+  return wire ? wire->probeCount() : 0;
+}
+
+uint8_t DallasTemperature::getDS18Count()
+{
+  return getDeviceCount();
+}
+
+bool DallasTemperature::validAddress(const uint8_t* addr)
+{
+  return OneWire::crc8(addr, 7) == addr[7];
+}
+
+bool DallasTemperature::validFamily(const uint8_t* addr)
+{
+  return addr[0] == DS18B20MODEL;
+}
+
+bool DallasTemperature::getAddress(uint8_t* addr, uint8_t index)
+{
+  // like the real library, walk the ROM search from the start until we reach index
+  if(wire == NULL)
+    return false;
+  wire->reset_search();
+  uint8_t depth = 0;
+  while(wire->search(addr)) {
+    if(depth == index && validAddress(addr))
+      return true;
+    depth++;
+  }
+  return false;
+}
+
+bool DallasTemperature::isConnected(const uint8_t* addr)
+{
+  if(wire == NULL || addr[0] != DS18B20MODEL || addr[2] != wire->pin)
+    return false;
+  return addr[1] < wire->probeCount() && validAddress(addr);
+}
+
+uint8_t DallasTemperature::getResolution()
+{
+  return resolution;
+}
+
+void DallasTemperature::setResolution(uint8_t newResolution)
+{
+  resolution = constrain(newResolution, 9, 12);
+}
+
+bool DallasTemperature::setResolution(const uint8_t* addr, uint8_t newResolution, bool skipGlobalBitResolutionCalculation)
+{
+  setResolution(newResolution);
+  return isConnected(addr);
+}
+
+int16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution)
+{
+  switch(bitResolution) {
+    case 9: return 94;
+    case 10: return 188;
+    case 11: return 375;
+    default: return 750;
+  }
+}
+
+void DallasTemperature::requestTemperatures()
+{
+  conversionStarted = millis();
+  conversionComplete = conversionStarted + millisToWaitForConversion(resolution);
+  if(waitForConversion)
+    delay(millisToWaitForConversion(resolution));
+}
+
+bool DallasTemperature::requestTemperaturesByAddress(const uint8_t* addr)
+{
+  requestTemperatures();
+  return isConnected(addr);
+}
+
+bool DallasTemperature::requestTemperaturesByIndex(uint8_t index)
+{
+  DeviceAddress addr;
+  return getAddress(addr, index) && requestTemperaturesByAddress(addr);
+}
+
+bool DallasTemperature::isConversionComplete()
+{
+  return (long)(millis() - conversionComplete) >= 0;
+}
+
+float DallasTemperature::getTempC(const uint8_t* addr)
+{
+  if(!isConnected(addr))
+    return DEVICE_DISCONNECTED_C;
+  if(conversionStarted == 0 && conversionComplete == 0)
+    return 85.0f;   // power-on reset value, no conversion has been requested yet
+  // probes sit at slightly different temperatures and drift slowly with the conversion time
+  float c = 18.0f + addr[1] * 0.5f + (float)sin(conversionStarted / 300000.0 + addr[1]);
+  // quantize to the configured resolution, 0.5C at 9 bits down to 0.0625C at 12 bits
+  float step = 0.5f / (float)(1 << (resolution - 9));
+  return floorf(c / step) * step;
+}
+
+float DallasTemperature::getTempF(const uint8_t* addr)
+{
+  float c = getTempC(addr);
+  return (c <= DEVICE_DISCONNECTED_C) ? (float)DEVICE_DISCONNECTED_F : toFahrenheit(c);
+}
+
+float DallasTemperature::getTempCByIndex(uint8_t index)
+{
+  DeviceAddress addr;
+  if(!getAddress(addr, index))
+    return DEVICE_DISCONNECTED_C;
+  return getTempC(addr);
+}
+
+float DallasTemperature::getTempFByIndex(uint8_t index)
+{
+  DeviceAddress addr;
+  if(!getAddress(addr, index))
+    return DEVICE_DISCONNECTED_F;
+  return getTempF(addr);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file DallasTemperature.h
+ * @brief Host (native) stand-in for the Dallas/Maxim DS18B20 temperature library.
+ * Conversion time follows the configured resolution. In wait-for-conversion mode requestTemperatures() blocks with
+ * delay() just like the real library, so the stall is visible in the host clock.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C   -127
+#define DEVICE_DISCONNECTED_F   -196.6
+#define DEVICE_DISCONNECTED_RAW -7040
+
+#define DS18B20MODEL 0x28
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature
+{
+  public:
+    DallasTemperature();
+    DallasTemperature(OneWire* _wire);
+
+    void setOneWire(OneWire* _wire) { wire = _wire; }
+    void begin();
+
+    uint8_t getDeviceCount();
+    uint8_t getDS18Count();
+
+    bool validAddress(const uint8_t* addr);
+    bool validFamily(const uint8_t* addr);
+    bool getAddress(uint8_t* addr, uint8_t index);
+    bool isConnected(const uint8_t* addr);
+
+    uint8_t getResolution();
+    void setResolution(uint8_t newResolution);
+    bool setResolution(const uint8_t* addr, uint8_t newResolution, bool skipGlobalBitResolutionCalculation=false);
+
+    void setWaitForConversion(bool flag) { waitForConversion = flag; }
+    bool getWaitForConversion() { return waitForConversion; }
+    void setCheckForConversion(bool flag) {}
+    bool getCheckForConversion() { return true; }
+
+    void requestTemperatures();
+    bool requestTemperaturesByAddress(const uint8_t* addr);
+    bool requestTemperaturesByIndex(uint8_t index);
+    bool isConversionComplete();
+    int16_t millisToWaitForConversion(uint8_t resolution);
+
+    float getTempC(const uint8_t* addr);
+    float getTempF(const uint8_t* addr);
+    float getTempCByIndex(uint8_t index);
+    float getTempFByIndex(uint8_t index);
+
+    static float toFahrenheit(float celsius) { return celsius * 1.8f + 32.0f; }
+
+  protected:
+    OneWire* wire;
+    uint8_t resolution;
+    bool waitForConversion;
+    unsigned long conversionStarted;
+    unsigned long conversionComplete;
+};
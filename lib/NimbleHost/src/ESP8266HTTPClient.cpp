@@ -0,0 +1,81 @@
+#include "ESP8266HTTPClient.h"
+#include "NimbleHost.h"
+
+
+namespace NimbleHost {
+
+  static HttpClientHandler httpClientHandler;
+
+  void onHttpClient(HttpClientHandler handler)
+  {
+    httpClientHandler = handler;
+  }
+
+  bool hasHttpClientHandler()
+  {
+    return (bool)httpClientHandler;
+  }
+
+  int handleHttpClient(const char* method, const String& url, const String& body, String& response)
+  {
+    return httpClientHandler(method, url, body, response);
+  }
+}
+
+
+HTTPClient::HTTPClient()
+{
+}
+
+bool HTTPClient::begin(const String& _url)
+{
+  url = _url;
+  response = String();
+  return true;
+}
+
+void HTTPClient::end()
+{
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace)
+{
+}
+
+void HTTPClient::setTimeout(uint16_t timeout)
+{
+}
+
+int HTTPClient::GET()
+{
+  return sendRequest("GET", NULL, 0);
+}
+
+int HTTPClient::POST(const String& payload)
+{
+  return sendRequest("POST", (const uint8_t*)payload.c_str(), payload.length());
+}
+
+int HTTPClient::POST(const uint8_t* payload, size_t size)
+{
+  return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size)
+{
+  response = String();
+  if(!NimbleHost::hasHttpClientHandler())
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  String body((const char*)payload, (unsigned int)size);
+  return NimbleHost::handleHttpClient(method, url, body, response);
+}
+
+String HTTPClient::getString()
+{
+  return response;
+}
+
+int HTTPClient::getSize()
+{
+  return (int)response.length();
+}
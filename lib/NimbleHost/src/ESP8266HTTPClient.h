@@ -0,0 +1,50 @@
+/**
+ * @file ESP8266HTTPClient.h
+ * @brief Host (native) stand-in for the ESP8266 HTTPClient.
+ * Requests are passed to the handler installed with NimbleHost::onHttpClient(), without one every request fails as if
+ * the server refused the connection.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+class HTTPClient
+{
+  public:
+    HTTPClient();
+
+    bool begin(const String& url);
+    void end();
+
+    void addHeader(const String& name, const String& value, bool first=false, bool replace=true);
+    void setTimeout(uint16_t timeout);
+
+    int GET();
+    int POST(const String& payload);
+    int POST(const uint8_t* payload, size_t size);
+    int sendRequest(const char* method, const uint8_t* payload, size_t size);
+
+    String getString();
+    int getSize();
+
+  protected:
+    String url;
+    String response;
+};
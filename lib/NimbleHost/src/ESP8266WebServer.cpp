@@ -0,0 +1,271 @@
+#include "ESP8266WebServer.h"
+#include "ESP8266mDNS.h"
+
+
+ESP8266WiFiClass WiFi;
+MDNSResponder MDNS;
+
+
+String IPAddress::toString() const
+{
+  String s;
+  for(int i=0; i<4; i++) {
+    if(i>0) s += '.';
+    s += (int)(*this)[i];
+  }
+  return s;
+}
+
+size_t IPAddress::printTo(Print& p) const
+{
+  return p.print(toString());
+}
+
+
+/// @brief wraps an on(uri, ...) function handler the same way the ESP8266 core does
+class FunctionRequestHandler : public RequestHandler
+{
+  public:
+    FunctionRequestHandler(ESP8266WebServer::THandlerFunction fn, ESP8266WebServer::THandlerFunction ufn, const String& uri, HTTPMethod method)
+      : _fn(fn), _ufn(ufn), _uri(uri), _method(method)
+    {
+    }
+
+    virtual bool canHandle(HTTPMethod requestMethod, String requestUri) {
+      return (_method == HTTP_ANY || _method == requestMethod) && requestUri == _uri;
+    }
+
+    virtual bool handle(ESP8266WebServer& server, HTTPMethod requestMethod, String requestUri) {
+      if(!canHandle(requestMethod, requestUri))
+        return false;
+      _fn();
+      return true;
+    }
+
+  protected:
+    ESP8266WebServer::THandlerFunction _fn;
+    ESP8266WebServer::THandlerFunction _ufn;
+    String _uri;
+    HTTPMethod _method;
+};
+
+
+ESP8266WebServer::ESP8266WebServer(int port)
+  : keepContent(true), firstHandler(nullptr), lastHandler(nullptr), currentMethod(HTTP_ANY), contentLength(CONTENT_LENGTH_NOT_SET)
+{
+  response.code = 0;
+  response.contentLength = 0;
+  response.chunks = 0;
+  response.chunked = false;
+}
+
+ESP8266WebServer::~ESP8266WebServer()
+{
+}
+
+void ESP8266WebServer::begin()
+{
+}
+
+void ESP8266WebServer::close()
+{
+}
+
+void ESP8266WebServer::stop()
+{
+}
+
+void ESP8266WebServer::handleClient()
+{
+  if(requests.empty())
+    return;
+  Request r = requests.front();
+  requests.pop_front();
+  dispatch(r);
+}
+
+void ESP8266WebServer::on(const String& uri, THandlerFunction handler)
+{
+  on(uri, HTTP_ANY, handler);
+}
+
+void ESP8266WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn)
+{
+  on(uri, method, fn, THandlerFunction());
+}
+
+void ESP8266WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn)
+{
+  addHandler(new FunctionRequestHandler(fn, ufn, uri, method));
+}
+
+void ESP8266WebServer::addHandler(RequestHandler* handler)
+{
+  if(!lastHandler) {
+    firstHandler = lastHandler = handler;
+  } else {
+    lastHandler->next(handler);
+    lastHandler = handler;
+  }
+}
+
+void ESP8266WebServer::onNotFound(THandlerFunction fn)
+{
+  notFoundHandler = fn;
+}
+
+void ESP8266WebServer::onFileUpload(THandlerFunction fn)
+{
+}
+
+String ESP8266WebServer::arg(const String& name) const
+{
+  for(size_t i=0; i<currentArgs.size(); i++)
+    if(currentArgs[i].key == name)
+      return currentArgs[i].value;
+  return String();
+}
+
+String ESP8266WebServer::arg(int i) const
+{
+  return (i>=0 && i<(int)currentArgs.size()) ? currentArgs[i].value : String();
+}
+
+String ESP8266WebServer::argName(int i) const
+{
+  return (i>=0 && i<(int)currentArgs.size()) ? currentArgs[i].key : String();
+}
+
+int ESP8266WebServer::args() const
+{
+  return (int)currentArgs.size();
+}
+
+bool ESP8266WebServer::hasArg(const String& name) const
+{
+  for(size_t i=0; i<currentArgs.size(); i++)
+    if(currentArgs[i].key == name)
+      return true;
+  return false;
+}
+
+String ESP8266WebServer::header(const String& name) const
+{
+  return String();
+}
+
+void ESP8266WebServer::sendHeader(const String& name, const String& value, bool first)
+{
+}
+
+void ESP8266WebServer::setContentLength(size_t _contentLength)
+{
+  contentLength = _contentLength;
+}
+
+void ESP8266WebServer::send(int code, const char* content_type, const String& content)
+{
+  response.code = code;
+  response.contentType = content_type ? content_type : "text/html";
+  response.chunked = (contentLength == CONTENT_LENGTH_UNKNOWN);
+  response.content = keepContent ? content : String();
+  response.contentLength = content.length();
+  response.chunks = 0;
+  contentLength = CONTENT_LENGTH_NOT_SET;
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P content_type, PGM_P content)
+{
+  send(code, content_type, String(content));
+}
+
+void ESP8266WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t _contentLength)
+{
+  setContentLength(_contentLength);
+  send(code, content_type, String());
+  sendContent(content, _contentLength);
+  response.chunks = 0;
+}
+
+void ESP8266WebServer::sendContent(const String& content)
+{
+  sendContent(content.c_str(), content.length());
+}
+
+void ESP8266WebServer::sendContent(const char* content, size_t size)
+{
+  if(keepContent)
+    response.content.concat(content, (unsigned int)size);
+  response.contentLength += size;
+  response.chunks++;
+}
+
+int ESP8266WebServer::request(HTTPMethod method, const String& uri, const String& body)
+{
+  Request r;
+  r.method = method;
+  r.uri = uri;
+  r.body = body;
+  dispatch(r);
+  return response.code;
+}
+
+void ESP8266WebServer::queue(HTTPMethod method, const String& uri, const String& body)
+{
+  Request r;
+  r.method = method;
+  r.uri = uri;
+  r.body = body;
+  requests.push_back(r);
+}
+
+void ESP8266WebServer::parseArguments(const String& query)
+{
+  const char* p = query.c_str();
+  while(*p) {
+    const char* amp = strchr(p, '&');
+    const char* end = amp ? amp : p + strlen(p);
+    const char* eq = (const char*)memchr(p, '=', end - p);
+    Argument a;
+    if(eq) {
+      a.key = String(p, (unsigned int)(eq - p));
+      a.value = String(eq + 1, (unsigned int)(end - eq - 1));
+    } else
+      a.key = String(p, (unsigned int)(end - p));
+    currentArgs.push_back(a);
+    p = amp ? amp + 1 : end;
+  }
+}
+
+void ESP8266WebServer::dispatch(const Request& r)
+{
+  int q = r.uri.indexOf('?');
+  currentMethod = r.method;
+  currentUri = (q >= 0) ? r.uri.substring(0, q) : r.uri;
+  currentArgs.clear();
+  if(q >= 0)
+    parseArguments(r.uri.substring(q + 1));
+  if(r.body.length() > 0) {
+    Argument plain;
+    plain.key = "plain";
+    plain.value = r.body;
+    currentArgs.push_back(plain);
+  }
+
+  response.code = 0;
+  response.contentType = String();
+  response.content = String();
+  response.contentLength = 0;
+  response.chunks = 0;
+  response.chunked = false;
+
+  for(RequestHandler* h = firstHandler; h; h = h->next()) {
+    if(h->canHandle(currentMethod, currentUri) && h->handle(*this, currentMethod, currentUri))
+      return;
+  }
+
+  if(notFoundHandler)
+    notFoundHandler();
+  else
+    send(404, "text/plain", String("Not found: ") + currentUri);
+}
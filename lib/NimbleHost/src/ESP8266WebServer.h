@@ -0,0 +1,174 @@
+/**
+ * @file ESP8266WebServer.h
+ * @brief Host (native) stand-in for the ESP8266 web server.
+ * There is no socket; requests are injected with request() or queue() and dispatched through the same handler chain
+ * the ESP8266 core uses. The most recent response is captured so a harness can inspect or discard it.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include <deque>
+#include <vector>
+
+#include "ESP8266WiFi.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+
+class ESP8266WebServer;
+
+typedef struct {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  size_t contentLength;
+  uint8_t buf[1];
+} HTTPUpload;
+
+class RequestHandler
+{
+  public:
+    inline RequestHandler() : _next(nullptr) {}
+    virtual ~RequestHandler() {}
+
+    virtual bool canHandle(HTTPMethod method, String uri) { return false; }
+    virtual bool canUpload(String uri) { return false; }
+    virtual bool handle(ESP8266WebServer& server, HTTPMethod requestMethod, String requestUri) { return false; }
+    virtual void upload(ESP8266WebServer& server, String requestUri, HTTPUpload& upload) {}
+
+    inline RequestHandler* next() { return _next; }
+    inline void next(RequestHandler* r) { _next = r; }
+
+  private:
+    RequestHandler* _next;
+};
+
+class ESP8266WebServer
+{
+  public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    /// @brief the captured response of the most recent request
+    struct Response {
+      int code;
+      String contentType;
+      String content;
+      size_t contentLength;     /// bytes of content sent, counted even when content is not kept
+      size_t chunks;            /// number of sendContent() calls
+      bool chunked;
+    };
+
+    ESP8266WebServer(int port=80);
+    virtual ~ESP8266WebServer();
+
+    void begin();
+    void close();
+    void stop();
+    void handleClient();
+
+    void on(const String& uri, THandlerFunction handler);
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn);
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn);
+    void addHandler(RequestHandler* handler);
+    void onNotFound(THandlerFunction fn);
+    void onFileUpload(THandlerFunction fn);
+
+    inline String uri() const { return currentUri; }
+    inline HTTPMethod method() const { return currentMethod; }
+    String arg(const String& name) const;
+    String arg(int i) const;
+    String argName(int i) const;
+    int args() const;
+    bool hasArg(const String& name) const;
+    String header(const String& name) const;
+
+    void sendHeader(const String& name, const String& value, bool first=false);
+    void setContentLength(size_t contentLength);
+    void send(int code, const char* content_type=NULL, const String& content=String(""));
+    inline void send(int code, char* content_type, const String& content) { send(code, (const char*)content_type, content); }
+    inline void send(int code, const String& content_type, const String& content) { send(code, content_type.c_str(), content); }
+    void send_P(int code, PGM_P content_type, PGM_P content);
+    void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength);
+    void sendContent(const String& content);
+    void sendContent(const char* content, size_t size);
+    inline void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+    inline void sendContent_P(PGM_P content, size_t size) { sendContent(content, size); }
+
+    template<typename T>
+    size_t streamFile(T& file, const String& contentType) {
+      setContentLength(file.size());
+      send(200, contentType.c_str(), String());
+      size_t sent = 0;
+      uint8_t buf[256];
+      int c;
+      size_t n = 0;
+      while((c = file.read()) >= 0) {
+        buf[n++] = (uint8_t)c;
+        if(n == sizeof(buf)) {
+          sendContent((const char*)buf, n);
+          sent += n;
+          n = 0;
+        }
+      }
+      if(n > 0) {
+        sendContent((const char*)buf, n);
+        sent += n;
+      }
+      return sent;
+    }
+
+    /// @name Host simulation
+    /// @{
+    /// @brief dispatch a request immediately, returns the response status code (or 0 if nothing responded)
+    int request(HTTPMethod method, const String& uri, const String& body=String());
+
+    /// @brief queue a request to be dispatched by the next handleClient()
+    void queue(HTTPMethod method, const String& uri, const String& body=String());
+
+    /// @brief number of queued requests waiting for handleClient()
+    inline size_t pending() const { return requests.size(); }
+
+    /// @brief when false response content is counted but not kept, useful for benchmarks
+    bool keepContent;
+
+    Response response;
+    /// @}
+
+  protected:
+    struct Request {
+      HTTPMethod method;
+      String uri;
+      String body;
+    };
+
+    struct Argument {
+      String key;
+      String value;
+    };
+
+    RequestHandler* firstHandler;
+    RequestHandler* lastHandler;
+    THandlerFunction notFoundHandler;
+    std::deque<Request> requests;
+
+    String currentUri;
+    HTTPMethod currentMethod;
+    std::vector<Argument> currentArgs;
+    size_t contentLength;
+
+    void dispatch(const Request& request);
+    void parseArguments(const String& query);
+};
@@ -0,0 +1,83 @@
+/**
+ * @file ESP8266WiFi.h
+ * @brief Host (native) stand-in for the ESP8266 WiFi station interface.
+ * The simulated station connects immediately and reports the loopback address.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "WiFiClient.h"
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} WiFiMode_t;
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_NONE_SLEEP = 0,
+  WIFI_LIGHT_SLEEP = 1,
+  WIFI_MODEM_SLEEP = 2
+} WiFiSleepType_t;
+
+class IPAddress : public Printable
+{
+  public:
+    inline IPAddress() : address(0) {}
+    inline IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | (b<<8) | (c<<16) | ((uint32_t)d<<24)) {}
+
+    inline operator uint32_t() const { return address; }
+    inline uint8_t operator[](int index) const { return (uint8_t)(address >> (8*index)); }
+
+    String toString() const;
+    virtual size_t printTo(Print& p) const;
+
+  protected:
+    uint32_t address;
+};
+
+class ESP8266WiFiClass
+{
+  public:
+    inline ESP8266WiFiClass() : _mode(WIFI_OFF), _status(WL_DISCONNECTED), _sleepType(WIFI_MODEM_SLEEP) {}
+
+    inline bool mode(WiFiMode_t m) { _mode = m; return true; }
+    inline WiFiMode_t getMode() const { return _mode; }
+
+    inline bool setSleepMode(WiFiSleepType_t type) { _sleepType = type; return true; }
+    inline WiFiSleepType_t getSleepMode() const { return _sleepType; }
+
+    inline bool hostname(const char* name) { return true; }
+
+    inline wl_status_t begin(const char* ssid, const char* passphrase=NULL) { return _status = WL_CONNECTED; }
+    inline uint8_t waitForConnectResult() { return _status; }
+    inline wl_status_t status() const { return _status; }
+    inline bool isConnected() const { return _status == WL_CONNECTED; }
+    inline bool disconnect(bool wifioff=false) { _status = WL_DISCONNECTED; return true; }
+
+    inline IPAddress localIP() const { return IPAddress(127,0,0,1); }
+
+  protected:
+    WiFiMode_t _mode;
+    wl_status_t _status;
+    WiFiSleepType_t _sleepType;
+};
+
+extern ESP8266WiFiClass WiFi;
@@ -0,0 +1,22 @@
+/**
+ * @file ESP8266mDNS.h
+ * @brief Host (native) stand-in for the ESP8266 mDNS responder, registrations are accepted and ignored.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class MDNSResponder
+{
+  public:
+    inline bool begin(const char* hostname) { return true; }
+    inline void addService(const char* service, const char* proto, uint16_t port) {}
+    inline void update() {}
+};
+
+extern MDNSResponder MDNS;
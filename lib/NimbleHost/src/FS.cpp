@@ -0,0 +1,239 @@
+#include "FS.h"
+#include "NimbleHost.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+
+fs::FS SPIFFS;
+
+namespace fs {
+
+  File::File()
+    : position(0), writable(false)
+  {
+  }
+
+  File::File(std::shared_ptr<FileTable> _table, const std::string& _path, bool _writable)
+    : table(_table), path(_path), position(0), writable(_writable)
+  {
+  }
+
+  std::string* File::contents() const
+  {
+    if(!table)
+      return nullptr;
+    FileTable::iterator itr = table->find(path);
+    return (itr != table->end()) ? &itr->second : nullptr;
+  }
+
+  size_t File::write(uint8_t c)
+  {
+    return write(&c, 1);
+  }
+
+  size_t File::write(const uint8_t* buffer, size_t size)
+  {
+    std::string* s = contents();
+    if(s==nullptr || !writable)
+      return 0;
+    s->append((const char*)buffer, size);
+    return size;
+  }
+
+  int File::available()
+  {
+    std::string* s = contents();
+    return (s && position < s->size()) ? (int)(s->size() - position) : 0;
+  }
+
+  int File::read()
+  {
+    std::string* s = contents();
+    return (s && position < s->size()) ? (unsigned char)(*s)[position++] : -1;
+  }
+
+  int File::peek()
+  {
+    std::string* s = contents();
+    return (s && position < s->size()) ? (unsigned char)(*s)[position] : -1;
+  }
+
+  size_t File::size() const
+  {
+    std::string* s = contents();
+    return s ? s->size() : 0;
+  }
+
+  const char* File::name() const
+  {
+    return path.c_str();
+  }
+
+  void File::close()
+  {
+    table.reset();
+  }
+
+
+  Dir::Dir()
+    : current(-1)
+  {
+  }
+
+  Dir::Dir(std::shared_ptr<FileTable> _table, std::vector<std::string> _entries)
+    : table(_table), entries(_entries), current(-1)
+  {
+  }
+
+  bool Dir::next()
+  {
+    if(current+1 >= (int)entries.size())
+      return false;
+    current++;
+    return true;
+  }
+
+  String Dir::fileName() const
+  {
+    return (current>=0 && current<(int)entries.size()) ? String(entries[current].c_str()) : String();
+  }
+
+  size_t Dir::fileSize() const
+  {
+    if(current<0 || current>=(int)entries.size())
+      return 0;
+    FileTable::const_iterator itr = table->find(entries[current]);
+    return (itr != table->end()) ? itr->second.size() : 0;
+  }
+
+  File Dir::openFile(const char* mode)
+  {
+    return (current>=0 && current<(int)entries.size()) ? SPIFFS.open(entries[current].c_str(), mode) : File();
+  }
+
+
+  FS::FS()
+    : table(std::make_shared<FileTable>())
+  {
+  }
+
+  bool FS::begin()
+  {
+    const char* root = getenv("NIMBLE_SPIFFS");
+    if(root && table->empty())
+      NimbleHost::mountSPIFFS(root);
+    return true;
+  }
+
+  void FS::end()
+  {
+  }
+
+  bool FS::format()
+  {
+    table->clear();
+    return true;
+  }
+
+  File FS::open(const char* path, const char* mode)
+  {
+    std::string p(path);
+    bool exists = table->find(p) != table->end();
+    switch(mode[0]) {
+      case 'r':
+        if(!exists)
+          return File();
+        return File(table, p, mode[1]=='+');
+      case 'w':
+        (*table)[p].clear();
+        return File(table, p, true);
+      case 'a':
+        (*table)[p];  // create if missing
+        return File(table, p, true);
+      default:
+        return File();
+    }
+  }
+
+  bool FS::exists(const char* path)
+  {
+    return table->find(path) != table->end();
+  }
+
+  bool FS::remove(const char* path)
+  {
+    return table->erase(path) > 0;
+  }
+
+  bool FS::rename(const char* pathFrom, const char* pathTo)
+  {
+    FileTable::iterator itr = table->find(pathFrom);
+    if(itr == table->end())
+      return false;
+    (*table)[pathTo] = itr->second;
+    table->erase(pathFrom);
+    return true;
+  }
+
+  Dir FS::openDir(const char* path)
+  {
+    std::string prefix(path);
+    if(prefix.empty() || prefix.back()!='/')
+      prefix += '/';
+
+    std::vector<std::string> entries;
+    for(FileTable::const_iterator itr = table->lower_bound(prefix); itr != table->end(); itr++) {
+      if(itr->first.compare(0, prefix.size(), prefix) != 0)
+        break;
+      entries.push_back(itr->first);
+    }
+    return Dir(table, entries);
+  }
+}
+
+
+namespace NimbleHost {
+
+  static int mountDirectory(const std::string& hostDir, const std::string& spiffsDir)
+  {
+    int loaded = 0;
+    DIR* dir = opendir(hostDir.c_str());
+    if(dir == NULL)
+      return 0;
+
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL) {
+      if(entry->d_name[0] == '.')
+        continue;
+      std::string hostPath = hostDir + "/" + entry->d_name;
+      std::string spiffsPath = spiffsDir + "/" + entry->d_name;
+
+      struct stat st;
+      if(stat(hostPath.c_str(), &st) != 0)
+        continue;
+      if(S_ISDIR(st.st_mode)) {
+        loaded += mountDirectory(hostPath, spiffsPath);
+      } else if(S_ISREG(st.st_mode)) {
+        FILE* f = fopen(hostPath.c_str(), "rb");
+        if(f) {
+          std::string contents;
+          char buf[512];
+          size_t n;
+          while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            contents.append(buf, n);
+          fclose(f);
+          SPIFFS.files()[spiffsPath] = contents;
+          loaded++;
+        }
+      }
+    }
+    closedir(dir);
+    return loaded;
+  }
+
+  int mountSPIFFS(const char* hostDir)
+  {
+    return mountDirectory(hostDir, "");
+  }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file FS.h
+ * @brief Host (native) stand-in for the ESP8266 SPIFFS filesystem.
+ * Files live in memory for the lifetime of the process. The image can be seeded from a host directory, typically the
+ * project data/ folder, using NimbleHost::mountSPIFFS() or the --spiffs=DIR command line option.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs {
+
+  typedef std::map<std::string, std::string> FileTable;
+
+  class File : public Stream
+  {
+    public:
+      File();
+      File(std::shared_ptr<FileTable> table, const std::string& path, bool writable);
+
+      virtual size_t write(uint8_t c);
+      virtual size_t write(const uint8_t* buffer, size_t size);
+      using Print::write;
+
+      virtual int available();
+      virtual int read();
+      virtual int peek();
+
+      size_t size() const;
+      const char* name() const;
+      void close();
+
+      inline operator bool() const { return table!=nullptr; }
+
+    protected:
+      std::shared_ptr<FileTable> table;
+      std::string path;
+      size_t position;
+      bool writable;
+
+      std::string* contents() const;
+  };
+
+  class Dir
+  {
+    public:
+      Dir();
+      Dir(std::shared_ptr<FileTable> table, std::vector<std::string> entries);
+
+      bool next();
+      String fileName() const;
+      size_t fileSize() const;
+      File openFile(const char* mode);
+
+    protected:
+      std::shared_ptr<FileTable> table;
+      std::vector<std::string> entries;
+      int current;
+  };
+
+  class FS
+  {
+    public:
+      FS();
+
+      bool begin();
+      void end();
+      bool format();
+
+      File open(const char* path, const char* mode);
+      inline File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+
+      bool exists(const char* path);
+      inline bool exists(const String& path) { return exists(path.c_str()); }
+
+      bool remove(const char* path);
+      inline bool remove(const String& path) { return remove(path.c_str()); }
+
+      bool rename(const char* pathFrom, const char* pathTo);
+
+      Dir openDir(const char* path);
+      inline Dir openDir(const String& path) { return openDir(path.c_str()); }
+
+      /// @brief host only, direct access to the file table for seeding from disk
+      inline FileTable& files() { return *table; }
+
+    protected:
+      std::shared_ptr<FileTable> table;
+  };
+}
+
+using fs::FS;
+using fs::File;
+using fs::Dir;
+
+extern fs::FS SPIFFS;
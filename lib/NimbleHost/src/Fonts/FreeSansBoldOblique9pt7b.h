@@ -0,0 +1,7 @@
+// Host (native) stand-in for the Adafruit GFX font FreeSansBoldOblique9pt7b.
+// Metrics only, glyph bitmaps are not shipped with the host build.
+#pragma once
+
+#include "../Adafruit_GFX.h"
+
+const GFXfont FreeSansBoldOblique9pt7b PROGMEM = { NULL, NULL, 0x20, 0x7E, 22 };
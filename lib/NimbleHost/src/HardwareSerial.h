@@ -0,0 +1,42 @@
+/**
+ * @file HardwareSerial.h
+ * @brief Host (native) stand-in for the Arduino Serial port.
+ * Output is written to stdout unless echo has been disabled with NimbleHost::setSerialEcho(false), which benchmarks
+ * do so console output does not dominate the measurement.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream
+{
+  public:
+    inline HardwareSerial() : echo(true), written(0) {}
+
+    void begin(unsigned long baud) {}
+    void end() {}
+
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    virtual void flush();
+
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    using Print::write;
+
+    inline operator bool() const { return true; }
+
+    /// @brief when false, output is counted but not sent to stdout
+    bool echo;
+
+    /// @brief total number of bytes written to the port
+    size_t written;
+};
+
+extern HardwareSerial Serial;
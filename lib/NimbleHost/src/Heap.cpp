@@ -0,0 +1,154 @@
+#include "NimbleHost.h"
+#include "HeapTelemetry.h"
+
+#include <malloc.h>
+
+// sanitizers replace the allocator themselves, counting is only available in a regular build
+#if defined(__SANITIZE_ADDRESS__)
+#define HOST_HEAP_COUNTERS 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define HOST_HEAP_COUNTERS 0
+#endif
+#endif
+#if !defined(HOST_HEAP_COUNTERS)
+#define HOST_HEAP_COUNTERS 1
+#endif
+
+
+namespace NimbleHost {
+
+  static HeapCounters counters;
+
+  const HeapCounters& heapCounters()
+  {
+    return counters;
+  }
+
+  bool heapCountersAvailable()
+  {
+    return HOST_HEAP_COUNTERS != 0;
+  }
+}
+
+#if HOST_HEAP_COUNTERS
+// the program's allocator functions take the place of the C library's, which remain reachable by their internal names
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t n, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+  void __libc_free(void* ptr);
+
+  static inline void counted(void* p)
+  {
+    if(p) {
+      NimbleHost::counters.allocations++;
+      NimbleHost::counters.liveBlocks++;
+      NimbleHost::counters.liveBytes += malloc_usable_size(p);
+    }
+  }
+
+  static inline void released(void* p)
+  {
+    if(p) {
+      NimbleHost::counters.frees++;
+      NimbleHost::counters.liveBlocks--;
+      NimbleHost::counters.liveBytes -= malloc_usable_size(p);
+    }
+  }
+
+#if defined(HEAP_TELEMETRY)
+  // blocks carry the HeapTelemetry header in front of the memory handed to the program
+  void* malloc(size_t size)
+  {
+    void* p = __libc_malloc(size + HeapTelemetry::HeaderSize);
+    counted(p);
+    return p ? HeapTelemetry::track(p, size, HeapTelemetry::currentTag()) : NULL;
+  }
+
+  void* calloc(size_t n, size_t size)
+  {
+    if(size > 0 && n > ((size_t)-1 - HeapTelemetry::HeaderSize) / size)
+      return NULL;
+    void* p = __libc_calloc(1, n * size + HeapTelemetry::HeaderSize);
+    counted(p);
+    return p ? HeapTelemetry::track(p, n * size, HeapTelemetry::currentTag()) : NULL;
+  }
+
+  void free(void* ptr)
+  {
+    if(ptr == NULL)
+      return;
+    void* p = HeapTelemetry::untrack(ptr);
+    if(p == NULL)
+      p = ptr;      // from an allocator function that is not replaced, such as posix_memalign
+    released(p);
+    __libc_free(p);
+  }
+
+  void* realloc(void* ptr, size_t size)
+  {
+    if(ptr == NULL)
+      return malloc(size);
+    if(size == 0) {
+      free(ptr);
+      return NULL;
+    }
+
+    size_t oldSize;
+    HeapTag tag;
+    void* block = HeapTelemetry::untrack(ptr, &oldSize, &tag);
+    if(block == NULL)
+      block = ptr;
+    size_t old = malloc_usable_size(block);
+    void* p = __libc_realloc(block, block != ptr ? size + HeapTelemetry::HeaderSize : size);
+    if(p == NULL) {
+      if(block != ptr)
+        HeapTelemetry::track(block, oldSize, tag);    // the old block is untouched
+      return NULL;
+    }
+    NimbleHost::counters.frees++;
+    NimbleHost::counters.liveBlocks--;
+    NimbleHost::counters.liveBytes -= old;
+    counted(p);
+    return (block != ptr) ? HeapTelemetry::track(p, size, tag) : p;
+  }
+#else
+  void* malloc(size_t size)
+  {
+    void* p = __libc_malloc(size);
+    counted(p);
+    return p;
+  }
+
+  void* calloc(size_t n, size_t size)
+  {
+    void* p = __libc_calloc(n, size);
+    counted(p);
+    return p;
+  }
+
+  void* realloc(void* ptr, size_t size)
+  {
+    // a resize counts as a new allocation, it may move the block just like the ESP8266 allocator would
+    size_t old = ptr ? malloc_usable_size(ptr) : 0;
+    void* p = __libc_realloc(ptr, size);
+    if(p == NULL && size > 0)
+      return NULL;    // the old block is untouched
+    if(ptr) {
+      NimbleHost::counters.frees++;
+      NimbleHost::counters.liveBlocks--;
+      NimbleHost::counters.liveBytes -= old;
+    }
+    counted(p);
+    return p;
+  }
+
+  void free(void* ptr)
+  {
+    released(ptr);
+    __libc_free(ptr);
+  }
+#endif
+}
+#endif
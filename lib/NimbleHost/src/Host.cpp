@@ -0,0 +1,262 @@
+#include "NimbleHost.h"
+
+#include <chrono>
+#include <thread>
+#include <malloc.h>
+
+
+namespace NimbleHost {
+
+  typedef std::chrono::steady_clock SteadyClock;
+
+  static SteadyClock::time_point epoch = SteadyClock::now();
+  static bool virtualClock = false;
+  static unsigned long long virtualMicros = 0;
+
+  struct PinState {
+    uint8_t mode;
+    int value;
+    int analog;
+    int interruptMode;
+    void (*isr)(void);
+    void (*isrArg)(void*);
+    void* arg;
+  };
+
+  static PinState pins[NUM_DIGITAL_PINS];
+  static bool interruptsEnabled = true;
+
+  short fleetDevices = 0;
+  short fleetSlots = 4;
+
+  static unsigned long long nowMicros()
+  {
+    if(virtualClock)
+      return virtualMicros;
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - epoch).count();
+  }
+
+  void useVirtualClock(bool enable)
+  {
+    if(enable && !virtualClock)
+      virtualMicros = nowMicros();
+    virtualClock = enable;
+  }
+
+  bool isVirtualClock()
+  {
+    return virtualClock;
+  }
+
+  void advanceClock(unsigned long ms)
+  {
+    virtualMicros += (unsigned long long)ms * 1000;
+  }
+
+  void advanceClockMicros(unsigned long us)
+  {
+    virtualMicros += us;
+  }
+
+  void setClock(unsigned long ms)
+  {
+    virtualMicros = (unsigned long long)ms * 1000;
+  }
+
+  void setPin(uint8_t pin, int value)
+  {
+    if(pin >= NUM_DIGITAL_PINS)
+      return;
+    PinState& p = pins[pin];
+    int previous = p.value;
+    p.value = value ? HIGH : LOW;
+    if(!interruptsEnabled || previous == p.value)
+      return;
+
+    bool fire = p.interruptMode == CHANGE
+      || (p.interruptMode == RISING && p.value == HIGH)
+      || (p.interruptMode == FALLING && p.value == LOW);
+    if(fire) {
+      if(p.isr)
+        p.isr();
+      else if(p.isrArg)
+        p.isrArg(p.arg);
+    }
+  }
+
+  void setAnalog(uint8_t pin, int value)
+  {
+    if(pin < NUM_DIGITAL_PINS)
+      pins[pin].analog = value;
+  }
+
+  void setSerialEcho(bool echo)
+  {
+    Serial.echo = echo;
+  }
+
+  unsigned long parseArguments(int argc, char** argv)
+  {
+    unsigned long loops = 0;
+    for(int i=1; i<argc; i++) {
+      const char* arg = argv[i];
+      if(strncmp(arg, "--loops=", 8)==0)
+        loops = strtoul(arg+8, NULL, 10);
+      else if(strncmp(arg, "--spiffs=", 9)==0)
+        mountSPIFFS(arg+9);
+      else if(strcmp(arg, "--virtual-clock")==0)
+        useVirtualClock(true);
+      else if(strcmp(arg, "--quiet")==0)
+        setSerialEcho(false);
+      else if(strncmp(arg, "--fleet=", 8)==0) {
+        char* end;
+        fleetDevices = (short)strtol(arg+8, &end, 10);
+        if(*end=='x')
+          fleetSlots = (short)strtol(end+1, NULL, 10);
+      }
+    }
+    return loops;
+  }
+}
+
+using namespace NimbleHost;
+
+
+unsigned long millis()
+{
+  return (unsigned long)(nowMicros() / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)nowMicros();
+}
+
+void delay(unsigned long ms)
+{
+  if(virtualClock)
+    virtualMicros += (unsigned long long)ms * 1000;
+  else if(ms > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  if(virtualClock)
+    virtualMicros += us;
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if(pin < NUM_DIGITAL_PINS) {
+    pins[pin].mode = mode;
+    if(mode == INPUT_PULLUP)
+      pins[pin].value = HIGH;
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  return (pin < NUM_DIGITAL_PINS) ? pins[pin].value : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if(pin < NUM_DIGITAL_PINS)
+    pins[pin].value = val ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+  return (pin < NUM_DIGITAL_PINS) ? pins[pin].analog : 0;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+  if(pin < NUM_DIGITAL_PINS) {
+    PinState& p = pins[pin];
+    p.isr = isr;
+    p.isrArg = NULL;
+    p.arg = NULL;
+    p.interruptMode = mode;
+  }
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode)
+{
+  if(pin < NUM_DIGITAL_PINS) {
+    PinState& p = pins[pin];
+    p.isr = NULL;
+    p.isrArg = isr;
+    p.arg = arg;
+    p.interruptMode = mode;
+  }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  if(pin < NUM_DIGITAL_PINS) {
+    PinState& p = pins[pin];
+    p.isr = NULL;
+    p.isrArg = NULL;
+    p.arg = NULL;
+    p.interruptMode = 0;
+  }
+}
+
+void interrupts()
+{
+  interruptsEnabled = true;
+}
+
+void noInterrupts()
+{
+  interruptsEnabled = false;
+}
+
+
+EspClass ESP;
+
+void EspClass::wdtEnable(uint32_t) {}
+void EspClass::wdtDisable() {}
+void EspClass::wdtFeed() {}
+
+void EspClass::restart()
+{
+  Serial.println("ESP.restart() called, exiting host process");
+  exit(1);
+}
+
+void EspClass::reset()
+{
+  restart();
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+  struct mallinfo2 mi = mallinfo2();
+  return (uint32_t)mi.fordblks;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize()
+{
+  // glibc does not expose the largest free chunk, the free arena size is the best available upper bound
+  return getFreeHeap();
+}
+
+uint8_t EspClass::getHeapFragmentation()
+{
+  return 0;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  // the ESP8266 runs at 80MHz, so 80 cycles per microsecond
+  return (uint32_t)(nowMicros() * 80);
+}
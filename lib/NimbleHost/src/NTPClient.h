@@ -0,0 +1,39 @@
+/**
+ * @file NTPClient.h
+ * @brief Host (native) stand-in for the NTPClient library.
+ * Time is taken from the workstation clock, so the client is always synchronized.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "WiFiUdp.h"
+
+class NTPClient
+{
+  public:
+    inline NTPClient(WiFiUDP& udp, long timeOffset=0) : offset(timeOffset) {}
+
+    inline void begin() {}
+    inline void begin(int port) {}
+    inline bool update() { return true; }
+    inline bool forceUpdate() { return true; }
+    inline void end() {}
+
+    inline void setTimeOffset(int timeOffset) { offset = timeOffset; }
+    inline unsigned long getEpochTime() const { return (unsigned long)time(NULL) + offset; }
+
+    inline int getDay() const { return (int)(((getEpochTime() / 86400L) + 4) % 7); }
+    inline int getHours() const { return (int)((getEpochTime() % 86400L) / 3600); }
+    inline int getMinutes() const { return (int)((getEpochTime() % 3600) / 60); }
+    inline int getSeconds() const { return (int)(getEpochTime() % 60); }
+
+  protected:
+    long offset;
+};
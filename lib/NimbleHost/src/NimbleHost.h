@@ -0,0 +1,105 @@
+/**
+ * @file NimbleHost.h
+ * @brief Controls the simulated hardware of the host (native) build.
+ * Benchmarks and tests use these functions to drive time, GPIO pins and attached peripherals so the Nimble core can be
+ * exercised deterministically on a workstation.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+namespace NimbleHost {
+
+  /// @name Clock
+  /// By default millis() follows the wall clock. With a virtual clock time only moves when advanced explicitly or by
+  /// a call to delay(), which makes blocking drivers show up as simulated time rather than real sleeps.
+  /// @{
+  void useVirtualClock(bool enable=true);
+  bool isVirtualClock();
+  void advanceClock(unsigned long ms);
+  void advanceClockMicros(unsigned long us);
+  void setClock(unsigned long ms);
+  /// @}
+
+  /// @name GPIO
+  /// @{
+  /// @brief Drive an input pin as if by external hardware, firing any attached interrupt on a matching edge
+  void setPin(uint8_t pin, int value);
+  void setAnalog(uint8_t pin, int value);
+  /// @}
+
+  /// @name Serial
+  /// @{
+  void setSerialEcho(bool echo);
+  /// @}
+
+  /// @name SPIFFS
+  /// @{
+  /// @brief Load every file below hostDir into the simulated SPIFFS, hostDir itself becomes the root '/'
+  int mountSPIFFS(const char* hostDir);
+  /// @}
+
+  /// @name OneWire
+  /// @{
+  /// @brief Attach count simulated DS18B20 probes to the OneWire bus on the given pin
+  void setOneWireProbes(uint8_t pin, uint8_t count);
+  /// @}
+
+  /// @name I2C
+  /// @{
+  /// @brief A simulated peripheral attached to the I2C (Wire) bus
+  class I2CPeripheral {
+    public:
+      virtual ~I2CPeripheral() {}
+
+      /// @brief master wrote a transmission to this peripheral
+      virtual void receive(const uint8_t* data, size_t length) = 0;
+
+      /// @brief master requested up to length bytes, returns the number of bytes placed in data
+      virtual size_t request(uint8_t* data, size_t length) = 0;
+  };
+
+  void attachI2C(uint8_t address, I2CPeripheral* peripheral);
+  void detachI2C(uint8_t address);
+
+  /// @brief the peripheral attached at an address, or NULL
+  I2CPeripheral* findI2C(uint8_t address);
+  /// @}
+
+  /// @name Heap
+  /// @{
+  /// @brief Counts of the calls made to the allocator, including those made by String and operator new
+  struct HeapCounters {
+    unsigned long allocations;    // malloc, calloc and realloc calls
+    unsigned long frees;
+    long liveBlocks;
+    long long liveBytes;
+  };
+
+  const HeapCounters& heapCounters();
+
+  /// @brief false in sanitizer builds, which supply their own allocator, the counters then stay 0
+  bool heapCountersAvailable();
+  /// @}
+
+  /// @name HTTP client
+  /// @{
+  /// @brief Handles requests made through HTTPClient or WiFiClient, returns the HTTP status or a negative HTTPC_ERROR
+  /// code
+  typedef std::function<int(const char* method, const String& url, const String& body, String& response)> HttpClientHandler;
+  void onHttpClient(HttpClientHandler handler);
+
+  /// @brief Milliseconds before a response to a request written through WiFiClient becomes readable
+  void setHttpLatency(unsigned long ms);
+  /// @}
+
+  /// @brief Parse common host command line options (--loops=N, --spiffs=DIR, --virtual-clock, --quiet,
+  /// --fleet=DEVICESxSLOTS)
+  /// @return the number of loop() iterations requested, or 0 to run forever
+  unsigned long parseArguments(int argc, char** argv);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file OneWire.h
+ * @brief Host (native) stand-in for the OneWire bus library.
+ * Probes are attached to a pin with NimbleHost::setOneWireProbes(). ROM searches are counted so the bus cost of a
+ * driver can be measured.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class OneWire
+{
+  public:
+    inline OneWire() : pin(0), searchIndex(0), searches(0) {}
+    inline OneWire(uint8_t _pin) : pin(_pin), searchIndex(0), searches(0) {}
+
+    uint8_t reset();
+    void reset_search();
+    bool search(uint8_t* newAddr, bool search_mode=true);
+
+    static uint8_t crc8(const uint8_t* addr, uint8_t len);
+
+    /// @brief host only, the number of probes on this bus
+    uint8_t probeCount() const;
+
+    /// @brief host only, the ROM address of the given probe on this bus
+    static void probeAddress(uint8_t pin, uint8_t index, uint8_t* addr);
+
+    uint8_t pin;
+    uint8_t searchIndex;
+
+    /// @brief host only, number of ROM search steps performed on this bus
+    unsigned long searches;
+};
@@ -0,0 +1,91 @@
+#include "Arduino.h"
+
+#include <stdarg.h>
+
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t n = 0;
+  while(size--)
+    n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char* format, ...)
+{
+  char buf[256];
+  va_list arg;
+  va_start(arg, format);
+  int len = vsnprintf(buf, sizeof(buf), format, arg);
+  va_end(arg);
+  if(len < 0)
+    return 0;
+  return write((const uint8_t*)buf, ((size_t)len < sizeof(buf)) ? (size_t)len : sizeof(buf)-1);
+}
+
+size_t Print::print(const char str[]) { return write(str); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return print((unsigned long)value, base); }
+size_t Print::print(int value, int base) { return print((long)value, base); }
+size_t Print::print(unsigned int value, int base) { return print((unsigned long)value, base); }
+size_t Print::print(unsigned long value, int base) { return printNumber(value, (uint8_t)base); }
+
+size_t Print::print(long value, int base)
+{
+  if(base == 10 && value < 0)
+    return print('-') + printNumber(-(unsigned long)value, 10);
+  return printNumber((unsigned long)value, (uint8_t)base);
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = 0;
+  if(base < 2)
+    base = 10;
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while(n);
+  return write(str);
+}
+size_t Print::print(double value, int digits) { return print(String(value, (unsigned char)digits)); }
+size_t Print::print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+size_t Print::print(const Printable& p) { return p.printTo(*this); }
+size_t Print::println() { return write((uint8_t)'\n'); }
+
+
+String Stream::readString()
+{
+  String s;
+  int c;
+  while((c = read()) >= 0)
+    s += (char)c;
+  return s;
+}
+
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  written++;
+  if(echo)
+    fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+  written += size;
+  if(echo)
+    fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+void HardwareSerial::flush()
+{
+  fflush(stdout);
+}
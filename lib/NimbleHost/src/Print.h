@@ -0,0 +1,57 @@
+/**
+ * @file Print.h
+ * @brief Host (native) stand-in for the Arduino Print and Printable classes.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "WString.h"
+
+class Print;
+
+class Printable
+{
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    inline size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    inline size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    size_t printf(const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+
+    size_t print(const char str[]);
+    size_t print(char c);
+    size_t print(unsigned char value, int base=10);
+    size_t print(int value, int base=10);
+    size_t print(unsigned int value, int base=10);
+    size_t print(long value, int base=10);
+    size_t print(unsigned long value, int base=10);
+    size_t print(double value, int digits=2);
+    size_t print(const String& s);
+    size_t print(const Printable& p);
+
+    size_t println();
+    template<class T> size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template<class T> size_t println(const T& value, int arg) { size_t n = print(value, arg); return n + println(); }
+
+  protected:
+    // like the ESP8266 core, integers are formatted on the stack without allocating
+    size_t printNumber(unsigned long n, uint8_t base);
+};
@@ -0,0 +1,19 @@
+/**
+ * @file SPI.h
+ * @brief Host (native) stand-in for the Arduino SPI bus, no SPI peripherals are simulated.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class SPIClass
+{
+  public:
+    void begin() {}
+    void end() {}
+};
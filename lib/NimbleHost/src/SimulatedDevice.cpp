@@ -0,0 +1,55 @@
+#include "SimulatedDevice.h"
+#include "NimbleHost.h"
+
+
+SimulatedDevice::SimulatedDevice(short id, short _slots, SensorType _sensorType, unsigned long _updateInterval, unsigned long _updateCost)
+  : Device(id, _slots, _updateInterval), sensorType(_sensorType), updateCost(_updateCost), updateCount(0)
+{
+  for(short i=0; i<_slots; i++)
+    (*this)[i] = SensorReading(sensorType, VT_CLEAR, 0);
+}
+
+const char* SimulatedDevice::getDriverName() const
+{
+  return "simulated";
+}
+
+void SimulatedDevice::handleUpdate()
+{
+  if(updateCost > 0)
+    delayMicroseconds(updateCost);
+
+  double t = millis() / 60000.0;
+  for(short i=0, _i=slotCount(); i<_i; i++)
+    (*this)[i] = SensorReading(sensorType, 20.0 + 5.0*sin(t + id + i*0.1));
+  updateCount++;
+  state = Nominal;
+}
+
+
+namespace NimbleHost {
+
+  short addSimulatedFleet(Devices& manager, short count, short slots, short firstId)
+  {
+    static const unsigned long intervals[] = { 250, 1000, 2500, 5000, 60000 };
+    const short ntypes = LastSensorType - FirstSensorType + 1;
+
+    if(count < 0)
+      count = fleetDevices;
+    if(slots < 0)
+      slots = fleetSlots;
+
+    short added = 0;
+    for(short i=0; i<count; i++) {
+      SensorType st = (SensorType)(FirstSensorType + i % ntypes);
+      unsigned long interval = intervals[i % (sizeof(intervals)/sizeof(intervals[0]))];
+      Device* dev = new SimulatedDevice(firstId + i, slots, st, interval);
+      if(manager.add(*dev) < 0) {
+        delete dev;
+        break;
+      }
+      added++;
+    }
+    return added;
+  }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file SimulatedDevice.h
+ * @brief A synthetic device for driving the Nimble core with large fleets on the host (native) build.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "NimbleAPI.h"
+
+/**
+ * @brief Produces synthetic readings on every slot.
+ * Each update writes a new value to all slots and can optionally consume simulated time to model a driver that
+ * blocks the loop while talking to its hardware.
+ */
+class SimulatedDevice : public Device
+{
+  public:
+    /**
+     * @brief Construct a new simulated device
+     *
+     * @param id The device id.
+     * @param _slots Number of slots to fill with readings.
+     * @param _sensorType Sensor type reported by every slot.
+     * @param _updateInterval Milliseconds between updates.
+     * @param _updateCost Microseconds each update should take, spent with delayMicroseconds().
+     */
+    SimulatedDevice(short id, short _slots, SensorType _sensorType=Temperature, unsigned long _updateInterval=1000, unsigned long _updateCost=0);
+
+    virtual const char* getDriverName() const;
+
+    virtual void handleUpdate();
+
+  public:
+    SensorType sensorType;
+    unsigned long updateCost;
+
+    /// number of times handleUpdate() was called
+    unsigned long updateCount;
+};
+
+namespace NimbleHost {
+  /// @brief fleet size requested on the command line with --fleet=DEVICESxSLOTS
+  extern short fleetDevices;
+  extern short fleetSlots;
+
+  /**
+   * @brief Add a fleet of simulated devices to a device manager
+   * Sensor types and update intervals are spread across the fleet so slots of every type are present.
+   *
+   * @param manager The device manager to add to.
+   * @param count Number of devices to add, defaults to the --fleet option.
+   * @param slots Number of slots per device, defaults to the --fleet option.
+   * @param firstId Device id of the first simulated device.
+   * @return The number of devices that were added.
+   */
+  short addSimulatedFleet(Devices& manager, short count=-1, short slots=-1, short firstId=100);
+}
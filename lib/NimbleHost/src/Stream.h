@@ -0,0 +1,24 @@
+/**
+ * @file Stream.h
+ * @brief Host (native) stand-in for the Arduino Stream class.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    /// read characters until the stream is exhausted
+    String readString();
+};
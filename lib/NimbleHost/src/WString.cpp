@@ -0,0 +1,335 @@
+#include "WString.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+
+static void formatInteger(char* buf, size_t n, unsigned long long value, bool negative, unsigned char base)
+{
+  char tmp[72];
+  char* p = tmp + sizeof(tmp) - 1;
+  *p = 0;
+  if(base < 2) base = 10;
+  do {
+    unsigned d = (unsigned)(value % base);
+    *--p = (char)(d < 10 ? '0'+d : 'a'+d-10);
+    value /= base;
+  } while(value);
+  if(negative)
+    *--p = '-';
+  snprintf(buf, n, "%s", p);
+}
+
+String::String(const char* cstr)
+  : buffer(NULL), capacity(0), len(0)
+{
+  if(cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, unsigned int length)
+  : buffer(NULL), capacity(0), len(0)
+{
+  if(cstr) copy(cstr, length);
+}
+
+String::String(const String& str)
+  : buffer(NULL), capacity(0), len(0)
+{
+  copy(str.c_str(), str.len);
+}
+
+String::String(String&& rval)
+  : buffer(rval.buffer), capacity(rval.capacity), len(rval.len)
+{
+  rval.buffer = NULL;
+  rval.capacity = rval.len = 0;
+}
+
+String::String(char c)
+  : buffer(NULL), capacity(0), len(0)
+{
+  copy(&c, 1);
+}
+
+String::String(unsigned char value, unsigned char base)
+  : String((unsigned long)value, base)
+{
+}
+
+String::String(int value, unsigned char base)
+  : String((long)value, base)
+{
+}
+
+String::String(unsigned int value, unsigned char base)
+  : String((unsigned long)value, base)
+{
+}
+
+String::String(long value, unsigned char base)
+  : buffer(NULL), capacity(0), len(0)
+{
+  char buf[72];
+  bool neg = value < 0 && base==10;
+  formatInteger(buf, sizeof(buf), neg ? -(unsigned long long)value : (unsigned long)value, neg, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base)
+  : buffer(NULL), capacity(0), len(0)
+{
+  char buf[72];
+  formatInteger(buf, sizeof(buf), value, false, base);
+  copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimalPlaces)
+  : String((double)value, decimalPlaces)
+{
+}
+
+String::String(double value, unsigned char decimalPlaces)
+  : buffer(NULL), capacity(0), len(0)
+{
+  char buf[48];
+  if(isnan(value))
+    strcpy(buf, "nan");
+  else if(isinf(value))
+    strcpy(buf, "inf");
+  else
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String()
+{
+  if(buffer)
+    free(buffer);
+}
+
+String& String::operator=(const String& rhs)
+{
+  if(this != &rhs)
+    copy(rhs.c_str(), rhs.len);
+  return *this;
+}
+
+String& String::operator=(String&& rval)
+{
+  if(this != &rval) {
+    if(buffer)
+      free(buffer);
+    buffer = rval.buffer;
+    capacity = rval.capacity;
+    len = rval.len;
+    rval.buffer = NULL;
+    rval.capacity = rval.len = 0;
+  }
+  return *this;
+}
+
+String& String::operator=(const char* cstr)
+{
+  if(cstr)
+    copy(cstr, strlen(cstr));
+  else
+    invalidate();
+  return *this;
+}
+
+void String::invalidate()
+{
+  if(buffer)
+    free(buffer);
+  buffer = NULL;
+  capacity = len = 0;
+}
+
+bool String::reserve(unsigned int size)
+{
+  if(buffer && capacity >= size)
+    return true;
+  if(changeBuffer(size)) {
+    if(len == 0)
+      buffer[0] = 0;
+    return true;
+  }
+  return false;
+}
+
+bool String::changeBuffer(unsigned int maxStrLen)
+{
+  char* newbuffer = (char*)realloc(buffer, maxStrLen + 1);
+  if(newbuffer) {
+    buffer = newbuffer;
+    capacity = maxStrLen;
+    return true;
+  }
+  return false;
+}
+
+String& String::copy(const char* cstr, unsigned int length)
+{
+  if(!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  len = length;
+  memmove(buffer, cstr, length);
+  buffer[len] = 0;
+  return *this;
+}
+
+bool String::concat(const char* cstr, unsigned int length)
+{
+  if(!cstr)
+    return false;
+  if(length == 0)
+    return true;
+  unsigned int newlen = len + length;
+  if(capacity < newlen && !reserve(newlen < 2*capacity ? 2*capacity : newlen))
+    return false;
+  memmove(buffer + len, cstr, length);
+  len = newlen;
+  buffer[len] = 0;
+  return true;
+}
+
+bool String::concat(const String& s) { return concat(s.c_str(), s.len); }
+bool String::concat(const char* cstr) { return cstr ? concat(cstr, strlen(cstr)) : false; }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(unsigned char num) { return concat(String(num)); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(long long num) { return concat(String((long)num)); }
+bool String::concat(unsigned long long num) { return concat(String((unsigned long)num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+int String::compareTo(const String& s) const
+{
+  return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String& s) const
+{
+  return len == s.len && compareTo(s) == 0;
+}
+
+bool String::equals(const char* cstr) const
+{
+  if(len == 0)
+    return cstr == NULL || *cstr == 0;
+  return cstr && strcmp(buffer, cstr) == 0;
+}
+
+bool String::startsWith(const String& prefix) const
+{
+  return prefix.len <= len && strncmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const
+{
+  return suffix.len <= len && strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const
+{
+  return (*this)[index];
+}
+
+char String::operator[](unsigned int index) const
+{
+  return (index < len) ? buffer[index] : 0;
+}
+
+char& String::operator[](unsigned int index)
+{
+  static char dummy_writable_char;
+  if(index >= len) {
+    dummy_writable_char = 0;
+    return dummy_writable_char;
+  }
+  return buffer[index];
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+  if(fromIndex >= len)
+    return -1;
+  const char* p = strchr(buffer + fromIndex, ch);
+  return p ? (int)(p - buffer) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const
+{
+  if(fromIndex >= len)
+    return -1;
+  const char* p = strstr(buffer + fromIndex, str.c_str());
+  return p ? (int)(p - buffer) : -1;
+}
+
+int String::lastIndexOf(char ch) const
+{
+  if(len == 0)
+    return -1;
+  const char* p = strrchr(buffer, ch);
+  return p ? (int)(p - buffer) : -1;
+}
+
+String String::substring(unsigned int left, unsigned int right) const
+{
+  if(left > right) {
+    unsigned int t = right;
+    right = left;
+    left = t;
+  }
+  if(left >= len)
+    return String();
+  if(right > len)
+    right = len;
+  return String(buffer + left, right - left);
+}
+
+void String::toLowerCase()
+{
+  for(unsigned int i=0; i<len; i++)
+    buffer[i] = (char)tolower(buffer[i]);
+}
+
+void String::toUpperCase()
+{
+  for(unsigned int i=0; i<len; i++)
+    buffer[i] = (char)toupper(buffer[i]);
+}
+
+void String::trim()
+{
+  if(len == 0)
+    return;
+  char* begin = buffer;
+  while(isspace(*begin))
+    begin++;
+  char* end = buffer + len - 1;
+  while(end >= begin && isspace(*end))
+    end--;
+  len = (unsigned int)(end + 1 - begin);
+  if(begin > buffer)
+    memmove(buffer, begin, len);
+  buffer[len] = 0;
+}
+
+long String::toInt() const
+{
+  return buffer ? atol(buffer) : 0;
+}
+
+float String::toFloat() const
+{
+  return buffer ? (float)atof(buffer) : 0;
+}
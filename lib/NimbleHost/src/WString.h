@@ -0,0 +1,103 @@
+/**
+ * @file WString.h
+ * @brief Host (native) stand-in for the Arduino String class.
+ * Like the Arduino original, a zero-filled String is a valid empty string. Nimble allocates some objects containing
+ * Strings with calloc() so this property must be preserved.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class String
+{
+  public:
+    String(const char* cstr = "");
+    String(const char* cstr, unsigned int length);
+    String(const String& str);
+    String(String&& rval);
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base=10);
+    explicit String(int value, unsigned char base=10);
+    explicit String(unsigned int value, unsigned char base=10);
+    explicit String(long value, unsigned char base=10);
+    explicit String(unsigned long value, unsigned char base=10);
+    explicit String(float value, unsigned char decimalPlaces=2);
+    explicit String(double value, unsigned char decimalPlaces=2);
+    ~String();
+
+    String& operator=(const String& rhs);
+    String& operator=(String&& rval);
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    inline unsigned int length() const { return len; }
+    inline const char* c_str() const { return buffer ? buffer : ""; }
+    inline bool isEmpty() const { return len==0; }
+
+    bool concat(const String& str);
+    bool concat(const char* cstr);
+    bool concat(const char* cstr, unsigned int length);
+    bool concat(char c);
+    bool concat(unsigned char c);
+    bool concat(int num);
+    bool concat(unsigned int num);
+    bool concat(long num);
+    bool concat(unsigned long num);
+    bool concat(long long num);
+    bool concat(unsigned long long num);
+    bool concat(float num);
+    bool concat(double num);
+
+    template<class T> String& operator+=(const T& rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+
+    int compareTo(const String& s) const;
+    bool equals(const String& s) const;
+    bool equals(const char* cstr) const;
+    inline bool operator==(const String& rhs) const { return equals(rhs); }
+    inline bool operator==(const char* cstr) const { return equals(cstr); }
+    inline bool operator!=(const String& rhs) const { return !equals(rhs); }
+    inline bool operator!=(const char* cstr) const { return !equals(cstr); }
+    inline bool operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+    inline bool operator>(const String& rhs) const { return compareTo(rhs) > 0; }
+
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const;
+    char& operator[](unsigned int index);
+
+    int indexOf(char ch, unsigned int fromIndex=0) const;
+    int indexOf(const String& str, unsigned int fromIndex=0) const;
+    int lastIndexOf(char ch) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, len); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+
+  protected:
+    char* buffer;
+    unsigned int capacity;
+    unsigned int len;
+
+    void invalidate();
+    bool changeBuffer(unsigned int maxStrLen);
+    String& copy(const char* cstr, unsigned int length);
+};
+
+template<class T> inline String operator+(const String& lhs, const T& rhs) { String s(lhs); s += rhs; return s; }
+inline String operator+(const char* lhs, const String& rhs) { String s(lhs); s += rhs; return s; }
+inline bool operator==(const char* lhs, const String& rhs) { return rhs.equals(lhs); }
+inline bool operator!=(const char* lhs, const String& rhs) { return !rhs.equals(lhs); }
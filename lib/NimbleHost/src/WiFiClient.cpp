@@ -0,0 +1,133 @@
+#include "WiFiClient.h"
+#include "NimbleHost.h"
+
+
+namespace NimbleHost {
+
+  static unsigned long httpLatency = 0;
+
+  void setHttpLatency(unsigned long ms)
+  {
+    httpLatency = ms;
+  }
+
+  // from ESP8266HTTPClient.cpp, requests of both clients go to the same handler
+  bool hasHttpClientHandler();
+  int handleHttpClient(const char* method, const String& url, const String& body, String& response);
+}
+
+
+WiFiClient::WiFiClient()
+  : port(0), open(false), responded(false), responsePos(0), respondAt(0)
+{
+}
+
+int WiFiClient::connect(const char* _host, uint16_t _port)
+{
+  stop();
+  if(!NimbleHost::hasHttpClientHandler())
+    return 0;
+  host = _host;
+  port = _port;
+  open = true;
+  return 1;
+}
+
+uint8_t WiFiClient::connected()
+{
+  // the server closes the connection once its response has been read
+  return open && (!responded || responsePos < response.length());
+}
+
+void WiFiClient::stop()
+{
+  open = false;
+  responded = false;
+  request = String();
+  response = String();
+  responsePos = 0;
+}
+
+size_t WiFiClient::availableForWrite()
+{
+  return (open && !responded) ? 1460 : 0;
+}
+
+size_t WiFiClient::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size)
+{
+  if(!open || responded)
+    return 0;
+  request.concat((const char*)buffer, (unsigned int)size);
+  dispatch();
+  return size;
+}
+
+void WiFiClient::dispatch()
+{
+  int headerEnd = request.indexOf("\r\n\r\n");
+  if(headerEnd < 0)
+    return;
+  unsigned int length = 0;
+  int cl = request.indexOf("Content-Length:");
+  if(cl >= 0 && cl < headerEnd)
+    length = (unsigned int)atol(request.c_str() + cl + 15);
+  if(request.length() < headerEnd + 4 + length)
+    return;   // body still to come
+
+  // request line is METHOD PATH HTTP/1.1
+  int methodEnd = request.indexOf(' ');
+  int pathEnd = request.indexOf(' ', methodEnd + 1);
+  String method = request.substring(0, methodEnd);
+  String url = "http://" + host + ":" + String(port) + request.substring(methodEnd + 1, pathEnd);
+  String body = request.substring(headerEnd + 4, headerEnd + 4 + length);
+
+  String content;
+  int status = NimbleHost::handleHttpClient(method.c_str(), url, body, content);
+  responded = true;
+  if(status < 0) {
+    open = false;   // connection dropped
+    return;
+  }
+  response = "HTTP/1.1 " + String(status) + " \r\nContent-Length: " + String(content.length()) +
+             "\r\nConnection: close\r\n\r\n" + content;
+  responsePos = 0;
+  respondAt = millis() + NimbleHost::httpLatency;
+}
+
+int WiFiClient::available()
+{
+  if(!responded || (long)(millis() - respondAt) < 0)
+    return 0;
+  return (int)(response.length() - responsePos);
+}
+
+int WiFiClient::read()
+{
+  if(available() <= 0)
+    return -1;
+  return (uint8_t)response[responsePos++];
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size)
+{
+  int n = available();
+  if(n > (int)size)
+    n = (int)size;
+  if(n > 0) {
+    memcpy(buffer, response.c_str() + responsePos, n);
+    responsePos += n;
+  }
+  return n;
+}
+
+int WiFiClient::peek()
+{
+  if(available() <= 0)
+    return -1;
+  return (uint8_t)response[responsePos];
+}
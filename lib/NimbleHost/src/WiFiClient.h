@@ -0,0 +1,52 @@
+/**
+ * @file WiFiClient.h
+ * @brief Host (native) stand-in for the ESP8266 WiFiClient.
+ * There is no network, a client speaks HTTP to the handler installed with NimbleHost::onHttpClient(). Once a whole
+ * request has been written it is passed to the handler and the response becomes readable after the latency set with
+ * NimbleHost::setHttpLatency(), like a slow server. A negative status from the handler drops the connection without a
+ * response. Without a handler connect() fails.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "Stream.h"
+
+class WiFiClient : public Stream
+{
+  public:
+    WiFiClient();
+
+    int connect(const char* host, uint16_t port);
+    uint8_t connected();
+    void stop();
+
+    inline void setNoDelay(bool nodelay) {}
+    inline void setTimeout(unsigned long timeout) {}
+
+    size_t availableForWrite();
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t* buffer, size_t size);
+
+    virtual int available();
+    virtual int read();
+    int read(uint8_t* buffer, size_t size);
+    virtual int peek();
+
+  protected:
+    String host;
+    uint16_t port;
+    bool open;
+    String request;
+    bool responded;
+    String response;
+    unsigned int responsePos;
+    unsigned long respondAt;
+
+    // pass the request to the handler once it is complete
+    void dispatch();
+};
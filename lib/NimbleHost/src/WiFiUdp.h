@@ -0,0 +1,19 @@
+/**
+ * @file WiFiUdp.h
+ * @brief Host (native) stand-in for the ESP8266 UDP socket. Only used to construct the NTP client.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class WiFiUDP
+{
+  public:
+    inline uint8_t begin(uint16_t port) { return 1; }
+    inline void stop() {}
+};
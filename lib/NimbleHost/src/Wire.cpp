@@ -0,0 +1,116 @@
+#include "Wire.h"
+#include "NimbleHost.h"
+
+
+TwoWire Wire;
+
+namespace NimbleHost {
+
+  static I2CPeripheral* peripherals[128];
+
+  void attachI2C(uint8_t address, I2CPeripheral* peripheral)
+  {
+    if(address < 128)
+      peripherals[address] = peripheral;
+  }
+
+  void detachI2C(uint8_t address)
+  {
+    if(address < 128)
+      peripherals[address] = NULL;
+  }
+
+  I2CPeripheral* findI2C(uint8_t address)
+  {
+    return (address < 128) ? peripherals[address] : NULL;
+  }
+}
+
+
+TwoWire::TwoWire()
+  : bytesTransferred(0), transactions(0), txAddress(0), txLength(0), transmitting(false), rxIndex(0), rxLength(0)
+{
+}
+
+void TwoWire::begin()
+{
+}
+
+void TwoWire::begin(int sda, int scl)
+{
+}
+
+void TwoWire::setClock(uint32_t frequency)
+{
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  txAddress = address;
+  txLength = 0;
+  transmitting = true;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t sendStop)
+{
+  transmitting = false;
+  transactions++;
+  bytesTransferred += 1 + txLength;
+
+  NimbleHost::I2CPeripheral* p = NimbleHost::findI2C(txAddress);
+  if(p == NULL)
+    return 2;   // received NACK on transmit of address
+  p->receive(txBuffer, txLength);
+  txLength = 0;
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool sendStop)
+{
+  if(quantity > I2C_BUFFER_LENGTH)
+    quantity = I2C_BUFFER_LENGTH;
+
+  transactions++;
+  rxIndex = rxLength = 0;
+  NimbleHost::I2CPeripheral* p = NimbleHost::findI2C(address);
+  if(p != NULL) {
+    // the master clocks out the full quantity, a peripheral with less to say sends 0xff
+    rxLength = p->request(rxBuffer, quantity);
+    for(size_t i=rxLength; i<quantity; i++)
+      rxBuffer[i] = 0xff;
+    rxLength = quantity;
+  }
+  bytesTransferred += 1 + rxLength;
+  return (uint8_t)rxLength;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+  if(!transmitting || txLength >= I2C_BUFFER_LENGTH)
+    return 0;
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity)
+{
+  size_t n = 0;
+  while(quantity-- && write(*data++))
+    n++;
+  return n;
+}
+
+int TwoWire::available()
+{
+  return (int)(rxLength - rxIndex);
+}
+
+int TwoWire::read()
+{
+  return (rxIndex < rxLength) ? rxBuffer[rxIndex++] : -1;
+}
+
+int TwoWire::peek()
+{
+  return (rxIndex < rxLength) ? rxBuffer[rxIndex] : -1;
+}
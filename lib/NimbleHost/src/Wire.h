@@ -0,0 +1,59 @@
+/**
+ * @file Wire.h
+ * @brief Host (native) stand-in for the Arduino I2C (Wire) bus.
+ * Transmissions are routed to simulated peripherals registered with NimbleHost::attachI2C(). Addresses without a
+ * peripheral NACK like an empty bus. The bus also counts the bytes it moves so I2C occupancy can be measured.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+class TwoWire : public Stream
+{
+  public:
+    TwoWire();
+
+    void begin();
+    void begin(int sda, int scl);
+    void setClock(uint32_t frequency);
+
+    void beginTransmission(uint8_t address);
+    inline void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(uint8_t sendStop=true);
+
+    uint8_t requestFrom(uint8_t address, size_t quantity, bool sendStop=true);
+    inline uint8_t requestFrom(int address, int quantity, int sendStop=1) { return requestFrom((uint8_t)address, (size_t)quantity, sendStop!=0); }
+
+    virtual size_t write(uint8_t data);
+    virtual size_t write(const uint8_t* data, size_t quantity);
+    using Print::write;
+
+    virtual int available();
+    virtual int read();
+    virtual int peek();
+
+    /// @brief host only, total bytes moved across the bus including address bytes
+    unsigned long bytesTransferred;
+
+    /// @brief host only, number of transactions (transmissions and requests) on the bus
+    unsigned long transactions;
+
+  protected:
+    uint8_t txAddress;
+    uint8_t txBuffer[I2C_BUFFER_LENGTH];
+    size_t txLength;
+    bool transmitting;
+
+    uint8_t rxBuffer[I2C_BUFFER_LENGTH];
+    size_t rxIndex;
+    size_t rxLength;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,17 @@
+#include "NimbleHost.h"
+
+/**
+ * @brief Host entry point, runs the sketch the same way the Arduino core does.
+ * Declared weak so a benchmark or test harness can supply its own main() and call setup()/loop() itself.
+ */
+__attribute__((weak)) int main(int argc, char** argv)
+{
+  unsigned long loops = NimbleHost::parseArguments(argc, argv);
+
+  setup();
+  for(unsigned long n=0; loops==0 || n<loops; n++)
+    loop();
+
+  Serial.flush();
+  return 0;
+}
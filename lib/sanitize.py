@@ -0,0 +1,4 @@
+Import("env")
+
+# sanitizer flags given in build_flags only reach the compiler, the linker needs them as well
+env.Append(LINKFLAGS=[f for f in env.get("CCFLAGS", []) if str(f).startswith("-fsanitize")])
@@ -0,0 +1,178 @@
+#include "AliasIndex.h"
+#include "Device.h"
+
+
+AliasIndex::AliasIndex()
+  : entries(NULL), capacity(0), used(0), deleted(0)
+{
+}
+
+AliasIndex::~AliasIndex()
+{
+  if(entries)
+    free(entries);
+}
+
+uint32_t AliasIndex::hash(const char* alias)
+{
+  uint32_t h = 2166136261u;
+  while(*alias) {
+    h ^= (uint8_t)*alias++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+uint32_t AliasIndex::scoped(uint32_t h, const Device* scope)
+{
+  // slot aliases are only unique within their device
+  if(scope) {
+    uintptr_t p = (uintptr_t)scope;
+    h ^= (uint32_t)(p ^ (p >> 16)) * 0x9E3779B1u;
+  }
+  return h;
+}
+
+bool AliasIndex::matches(const Entry& e, uint32_t h, const Device* scope, const char* alias) const
+{
+  if(e.hash != h || e.device == NULL)
+    return false;
+  if(scope == NULL) {
+    // device alias
+    return e.slot < 0 && e.device->alias == alias;
+  } else {
+    // slot alias of the scope device
+    return e.slot >= 0 && e.device == scope && e.slot < e.device->slotCount() && e.device->getSlotAlias(e.slot) == alias;
+  }
+}
+
+void AliasIndex::clear()
+{
+  if(entries)
+    memset(entries, 0, capacity * sizeof(Entry));
+  used = deleted = 0;
+}
+
+void AliasIndex::grow()
+{
+  Entry* old = entries;
+  unsigned int oldCapacity = capacity;
+
+  // double if mostly live entries, otherwise rehashing alone clears out the deleted entries
+  unsigned int newCapacity = (capacity == 0) ? 64 : (used*2 >= capacity) ? capacity*2 : capacity;
+  entries = (Entry*)calloc(newCapacity, sizeof(Entry));
+  if(entries == NULL) {
+    entries = old;
+    return;
+  }
+  capacity = newCapacity;
+  used = deleted = 0;
+
+  for(unsigned int i=0; i<oldCapacity; i++) {
+    const Entry& e = old[i];
+    if(e.device) {
+      unsigned int mask = capacity - 1;
+      unsigned int j = e.hash & mask;
+      while(entries[j].device)
+        j = (j + 1) & mask;
+      entries[j] = e;
+      used++;
+    }
+  }
+  if(old)
+    free(old);
+}
+
+void AliasIndex::add(Device* device, short slot, const char* alias)
+{
+  if(device == NULL || alias == NULL || *alias == 0)
+    return;
+
+  // keep at most 3/4 of the table occupied so probe sequences stay short
+  if((used + deleted + 1) * 4 > capacity * 3)
+    grow();
+  if(capacity == 0 || used + deleted + 1 >= capacity)
+    return;
+
+  if(slot < 0)
+    slot = -1;
+  uint32_t h = scoped(hash(alias), (slot < 0) ? NULL : device);
+  unsigned int mask = capacity - 1;
+  unsigned int i = h & mask;
+  long reuse = -1;
+  while(entries[i].device || entries[i].slot == Deleted) {
+    const Entry& e = entries[i];
+    if(e.device == device && e.slot == slot && e.hash == h)
+      return;   // already indexed
+    if(reuse < 0 && e.slot == Deleted)
+      reuse = i;
+    i = (i + 1) & mask;
+  }
+  if(reuse >= 0) {
+    i = reuse;
+    deleted--;
+  }
+  entries[i].hash = h;
+  entries[i].device = device;
+  entries[i].slot = slot;
+  used++;
+}
+
+void AliasIndex::remove(Device* device, short slot, const char* alias)
+{
+  if(capacity == 0 || device == NULL || alias == NULL || *alias == 0)
+    return;
+  if(slot < 0)
+    slot = -1;
+  uint32_t h = scoped(hash(alias), (slot < 0) ? NULL : device);
+  unsigned int mask = capacity - 1;
+  for(unsigned int i = h & mask; entries[i].device || entries[i].slot == Deleted; i = (i + 1) & mask) {
+    Entry& e = entries[i];
+    if(e.device == device && e.slot == slot && e.hash == h) {
+      e.device = NULL;
+      e.slot = Deleted;
+      used--;
+      deleted++;
+      return;
+    }
+  }
+}
+
+void AliasIndex::remove(Device* device)
+{
+  for(unsigned int i=0; i<capacity; i++) {
+    Entry& e = entries[i];
+    if(e.device == device) {
+      e.device = NULL;
+      e.slot = Deleted;
+      used--;
+      deleted++;
+    }
+  }
+}
+
+Device* AliasIndex::findDevice(const char* alias) const
+{
+  if(capacity == 0 || alias == NULL || *alias == 0)
+    return NULL;
+  uint32_t h = scoped(hash(alias), NULL);
+  unsigned int mask = capacity - 1;
+  for(unsigned int i = h & mask; entries[i].device || entries[i].slot == Deleted; i = (i + 1) & mask) {
+    if(matches(entries[i], h, NULL, alias))
+      return entries[i].device;
+  }
+  return NULL;
+}
+
+short AliasIndex::findSlot(const Device* device, const char* alias) const
+{
+  if(capacity == 0 || device == NULL || alias == NULL || *alias == 0)
+    return -1;
+  uint32_t h = scoped(hash(alias), device);
+  unsigned int mask = capacity - 1;
+  for(unsigned int i = h & mask; entries[i].device || entries[i].slot == Deleted; i = (i + 1) & mask) {
+    if(matches(entries[i], h, device, alias))
+      return entries[i].slot;
+  }
+  return -1;
+}
@@ -0,0 +1,56 @@
+#include "ChunkedResponse.h"
+
+
+ChunkedResponse::ChunkedResponse(ESP8266WebServer& _server, int code, const char* contentType)
+  : server(_server), length(0), ended(false)
+{
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(code, contentType, "");
+}
+
+ChunkedResponse::~ChunkedResponse()
+{
+  end();
+}
+
+size_t ChunkedResponse::write(uint8_t c)
+{
+  if(length >= sizeof(buffer))
+    flush();
+  buffer[length++] = (char)c;
+  return 1;
+}
+
+size_t ChunkedResponse::write(const uint8_t* data, size_t size)
+{
+  size_t n = size;
+  while(n > 0) {
+    if(length >= sizeof(buffer))
+      flush();
+    size_t chunk = sizeof(buffer) - length;
+    if(chunk > n)
+      chunk = n;
+    memcpy(buffer + length, data, chunk);
+    length += chunk;
+    data += chunk;
+    n -= chunk;
+  }
+  return size;
+}
+
+void ChunkedResponse::flush()
+{
+  if(length > 0) {
+    server.sendContent_P(buffer, length);
+    length = 0;
+  }
+}
+
+void ChunkedResponse::end()
+{
+  if(!ended) {
+    flush();
+    server.sendContent("");   // an empty chunk completes the response
+    ended = true;
+  }
+}
@@ -1,26 +1,36 @@
 
 #include "Device.h"
+#include "JsonStream.h"
+#include "HeapTelemetry.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 // a do-nothing device, returned whenever find fails
 Device NullDevice(-1, 0);
 
 
+// slot readings are plain data, the array is resized with realloc and the new slots constructed in place
+static_assert(std::is_trivially_copyable<SensorReading>::value, "SensorReading must remain plain data");
+
+
 Device::Device(short _id, short _slots, unsigned long _updateInterval, unsigned long _flags)
-  : id(_id), owner(NULL), slots(_slots), readings(NULL), flags(_flags), _endpoints(nullptr), updateInterval(_updateInterval), nextUpdate(0), state(Offline)
+  : id(_id), owner(NULL), slots(0), readings(NULL), slotAliases(NULL), flags(_flags), _endpoints(nullptr), updateInterval(_updateInterval), nextUpdate(0), scheduleIndex(-1), ordinal(-1), unpublished(true), state(Offline),
+    history(NULL), historySlots(0), historyBudget(DEFAULT_HISTORY_BUDGET)
 {
   if(_slots > MAX_SLOTS) 
     _slots = MAX_SLOTS;
   if(_slots>0)
-    readings = (Slot*)calloc(slots, sizeof(Slot));
+    alloc(_slots);
 }
 
 Device::Device(const Device& copy)
-  : id(copy.id), owner(copy.owner), slots(copy.slots), readings(NULL), flags(copy.flags), _endpoints(nullptr), updateInterval(copy.updateInterval), nextUpdate(0), state(copy.state)
+  : id(copy.id), owner(copy.owner), slots(0), readings(NULL), slotAliases(NULL), flags(copy.flags), _endpoints(nullptr), updateInterval(copy.updateInterval), nextUpdate(0), scheduleIndex(-1), ordinal(-1), unpublished(true), state(copy.state),
+    history(NULL), historySlots(0), historyBudget(copy.historyBudget)
 {
-  if(slots>0) {
-    readings = (Slot*)calloc(slots, sizeof(Slot));
-    memcpy(readings, copy.readings, slots*sizeof(Slot));  
-  }
+  copySlots(copy);
 }
 
 Device::~Device()
@@ -28,16 +38,17 @@ Device::~Device()
   // todo: notify our owner we are dying
   if(owner)
     owner->remove(*this);
-  if(readings)
-    free(readings);
+  freeSlots();
+  if(history)
+    delete[] history;
 }
 
 Device& Device::operator=(const Device& copy)
 {
+  if(this == &copy)
+    return *this;
   owner=copy.owner;
   id=copy.id;
-  slots=copy.slots;
-  readings=NULL;
   flags=copy.flags;
   #if 0
   // todo: Endpoints class needs a copy constructor/assignment
@@ -56,8 +67,10 @@ Device& Device::operator=(const Device& copy)
   updateInterval=copy.updateInterval;
   nextUpdate=copy.nextUpdate;
   state=copy.state;
-  readings = (Slot*)calloc(slots, sizeof(Slot));
-  memcpy(readings, copy.readings, slots*sizeof(Slot));
+  setHistoryBudget(copy.historyBudget);
+  copySlots(copy);
+  if(owner)
+    owner->reschedule(*this);
   return *this;
 }
 
@@ -68,7 +81,7 @@ void Device::setOwner(Devices* _owner)
 
 void Device::alloc(unsigned short _slots)
 {
-  if(_slots >=MAX_SLOTS) {
+  if(_slots > MAX_SLOTS) {
     // essentially crash, an unrealistic number of slots requested
     Serial.print("internal error: ");
     Serial.print(_slots);
@@ -77,11 +90,57 @@ void Device::alloc(unsigned short _slots)
     while(1) ::delay(10);
   }
   
-  if(_slots != slots || !readings) {
-    readings = readings
-      ? (Slot*)realloc(readings, _slots*sizeof(Slot))
-      : (Slot*)calloc(_slots, sizeof(Slot));
-    slots = _slots;
+  if(_slots == slots)
+    return;
+  if(_slots == 0) {
+    freeSlots();
+    return;
+  }
+
+  // readings may move, slots added at the end hold no reading
+  SensorReading* r = (SensorReading*)realloc(readings, _slots*sizeof(SensorReading));
+  if(r == NULL)
+    return;
+  if(_slots > slots)
+    std::uninitialized_fill_n(r + slots, _slots - slots, InvalidReading);
+  readings = r;
+
+  // aliases are objects, move them into a new array
+  if(slotAliases) {
+    String* a = new String[_slots];
+    for(unsigned short i=0; i<_slots && i<slots; i++)
+      a[i] = std::move(slotAliases[i]);
+    delete[] slotAliases;
+    slotAliases = a;
+  }
+  slots = _slots;
+}
+
+void Device::freeSlots()
+{
+  if(readings)
+    free(readings);
+  if(slotAliases)
+    delete[] slotAliases;
+  readings = NULL;
+  slotAliases = NULL;
+  slots = 0;
+}
+
+void Device::copySlots(const Device& copy)
+{
+  alloc(copy.slots);
+  std::copy_n(copy.readings, slots, readings);
+
+  if(copy.slotAliases) {
+    // assignment reuses the buffers of aliases we already have
+    if(slotAliases == NULL)
+      slotAliases = new String[slots];
+    for(unsigned short i=0; i<slots; i++)
+      slotAliases[i] = copy.slotAliases[i];
+  } else if(slotAliases) {
+    delete[] slotAliases;
+    slotAliases = NULL;
   }
 }
 
@@ -111,10 +170,13 @@ void Device::clear()
 void Device::delay(unsigned long _delay)
 {
   nextUpdate = millis() + _delay;
+  if(owner)
+    owner->reschedule(*this);
 }
 
 String Device::prefixUri(const String& uri, short slot) const
 {
+  HEAP_SCOPE(HeapWeb);
   String u;
   u += "/dev/";
   u += id;
@@ -162,24 +224,60 @@ void Device::jsonGetReadings(JsonObject& node) const
   }
 }
 
-String Device::getSlotAlias(short slotIndex) const
+void Device::jsonGetReadings(JsonStream& json) const
+{
+  json.beginArray("slots");
+  for(short i=0, _i=slotCount(); i<_i; i++) {
+    json.beginObject();
+    readings[i].toJson(json);
+    json.endObject();
+  }
+  json.endArray();
+}
+
+const String& Device::getSlotAlias(short slotIndex) const
+{
+  static const String blank;
+  return (slotAliases && slotIndex>=0 && slotIndex < slots)
+    ? slotAliases[slotIndex]
+    : blank;
+}
+
+void Device::setAlias(const String& _alias)
 {
-  return (slotIndex>=0 && slotIndex < slots)
-    ? readings[slotIndex].alias
-    : "";
+  if(owner)
+    owner->aliasIndex.remove(this, -1, alias.c_str());
+  alias = _alias;
+  if(owner)
+    owner->aliasIndex.add(this, -1, alias.c_str());
 }
 
-void Device::setSlotAlias(short slotIndex, String alias)
+void Device::setSlotAlias(short slotIndex, const String& alias)
 {
-  if (slotIndex>=0 && slotIndex < slots)
-    readings[slotIndex].alias = alias;
+  if (slotIndex>=0 && slotIndex < slots) {
+    if(slotAliases == NULL) {
+      if(alias.length() == 0)
+        return;   // nothing to clear
+      slotAliases = new String[slots];
+    }
+    String& slotAlias = slotAliases[slotIndex];
+    if(owner)
+      owner->aliasIndex.remove(this, slotIndex, slotAlias.c_str());
+    slotAlias = alias;
+    if(owner)
+      owner->aliasIndex.add(this, slotIndex, slotAlias.c_str());
+  }
 }
 
-short Device::findSlotByAlias(String slotAlias) const
+short Device::findSlotByAlias(const String& slotAlias) const
 {
-  if(slotAlias.length()>0) {
+  if(owner)
+    return owner->aliasIndex.findSlot(this, slotAlias.c_str());
+
+  // not managed, search the slots
+  if(slotAliases && slotAlias.length()>0) {
     for(short i=0, _i=slotCount(); i<_i; i++) {
-      if(readings[i].alias == slotAlias)
+      if(slotAliases[i] == slotAlias)
         return i;
     }
   }
@@ -190,11 +288,53 @@ void Device::handleUpdate()
 {
 }
 
+void Device::setHistoryBudget(size_t bytes)
+{
+  historyBudget = bytes;
+  if(history) {
+    delete[] history;
+    history = NULL;
+    historySlots = 0;
+  }
+}
+
+const SlotHistory* Device::getHistory(short slotIndex) const
+{
+  return (history && slotIndex>=0 && slotIndex < historySlots)
+    ? &history[slotIndex]
+    : NULL;
+}
+
+void Device::recordHistory()
+{
+  if(historyBudget==0 || slots==0)
+    return;
+
+  if(history==NULL || historySlots != slots) {
+    // (re)allocate, sharing the budget evenly between the slots
+    if(history)
+      delete[] history;
+    history = new SlotHistory[historySlots = slots];
+    size_t capacity = historyBudget / slots / SlotHistory::sampleSize();
+    if(capacity > 0xfffe)
+      capacity = 0xfffe;
+    for(short i=0; i<slots; i++)
+      history[i].alloc((unsigned short)capacity);
+  }
+
+  for(short i=0; i<slots; i++) {
+    const SensorReading& r = readings[i];
+    if(r && r.timestamp > history[i].lastTimestamp())
+      history[i].add(r);
+  }
+}
+
 bool Device::isStale(unsigned long _now) const
 {
   if(_now==0)
     _now = millis();
-  return _now > nextUpdate;
+  // a device that was never updated is stale, otherwise compare by difference so the deadline survives millis() wrap
+  return nextUpdate == 0 || (long)(_now - nextUpdate) > 0;
 }
 
 DeviceState Device::getState() const
@@ -204,16 +344,17 @@ DeviceState Device::getState() const
 
 SensorReading& Device::operator[](unsigned short slotIndex)
 {
+  unpublished = true;   // the reading is likely about to be written
   if(slotIndex >= slots)
     alloc( slotIndex+1 );
-  return readings[slotIndex].reading;
+  return readings[slotIndex];
 }
 
 const SensorReading& Device::operator[](unsigned short slotIndex) const
 {
   if(slotIndex >= slots)
     return InvalidReading;
-  return readings[slotIndex].reading;
+  return readings[slotIndex];
 }
 
 int Device::toJson(JsonObject& target, JsonFlags displayFlags) const
@@ -246,4 +387,54 @@ void Device::Statistics::toJson(JsonObject& target) const
   JsonObject _errors = target.createNestedObject("errors");
   _errors["bus"] = errors.bus;
   _errors["sensing"] = errors.sensing;
+  JsonObject _update = target.createNestedObject("updateMicros");
+  updateMicros.toJson(_update);
+  JsonObject _lateness = target.createNestedObject("latenessMillis");
+  latenessMillis.toJson(_lateness);
+}
+
+void Device::Statistics::toJson(JsonStream& json) const
+{
+  json.member("updates", updates);
+  json.beginObject("errors");
+  json.member("bus", errors.bus);
+  json.member("sensing", errors.sensing);
+  json.endObject();
+  json.beginObject("updateMicros");
+  updateMicros.toJson(json);
+  json.endObject();
+  json.beginObject("latenessMillis");
+  latenessMillis.toJson(json);
+  json.endObject();
+}
+
+void Device::toJson(JsonStream& json, JsonFlags displayFlags) const
+{
+  unsigned long long now = millis();
+  const char* driver = getDriverName();
+  if(alias.length()>0)
+    json.member("alias", alias);
+  if(driver)
+    json.member("driver", driver);
+  json.member("flags", getFlags());
+  json.member("state", DeviceStateName(getState()));
+
+  if(now < nextUpdate)
+    json.member("nextUpdate", (unsigned long)(nextUpdate - now));
+
+  if(displayFlags & JsonStatistics)
+    statistics.toJson(json);
+
+  if(displayFlags & JsonSlots)
+    jsonGetReadings(json);
+}
+
+int Device::restJson(RestRequest& request, JsonFlags displayFlags) const
+{
+  HttpJsonStream json(request.server);
+  json.beginObject();
+  toJson(json, displayFlags);
+  json.endObject();
+  json.end();
+  return HTTP_RESPONSE_SENT;
 }
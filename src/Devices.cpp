@@ -8,6 +8,9 @@
 
 #include "Devices.h"
 #include "Device.h"
+#include "JsonStream.h"
+#include "HeapTelemetry.h"
+#include "RequestArena.h"
 
 
 const char* SensorTypeName(SensorType st)
@@ -79,12 +82,15 @@ const DeviceDriverInfo* Devices::findDriver(const char* name)
 }
 
 Devices::Devices(short _maxDevices)
-  : slots(_maxDevices), devices(NULL), update_iterator(0), ntp(NULL), httpServer(NULL), restHandler(NULL) {
+  : slots(_maxDevices), devices(NULL), schedule(NULL), scheduled(0), updateBudget(DEFAULT_UPDATE_BUDGET),
+    ntp(NULL), httpServer(NULL), restHandler(NULL) {
     devices = (Device**)calloc(slots, sizeof(Device*));
+    schedule = (Device**)calloc(slots, sizeof(Device*));
 }
 
 Devices::~Devices() {
   if(devices) free(devices);
+  if(schedule) free(schedule);
 }
 
 #if 0
@@ -114,15 +120,12 @@ void Devices::begin(WebServer& _http, NTPClient& _ntp)
 void Devices::setupRestHandler()
 {  
   std::function<int(RestRequest&)> func = [](RestRequest& request) {
-    String s("Hello ");
+    // the response keeps a const char* by reference, the arena holds the reply until the response is sent
     auto msg = request["msg"];
-    if(msg.isString())
-      s += msg.toString();
-    else {
-      s += '#';
-      s += (long)msg;
-    }
-    request.response["reply"] = s;
+    const char* reply = msg.isString()
+        ? RequestScratch.format("Hello %s", (const char*)msg)
+        : RequestScratch.format("Hello #%ld", (long)msg);
+    request.response["reply"] = reply;
     return 200;
   };
 
@@ -198,7 +201,29 @@ void Devices::setupRestHandler()
   
   // Devices API
   on("/api/devices")
-    .GET([this](RestRequest& request) { jsonGetDevices(request.response); return 200; });
+    .GET([this](RestRequest& request) {
+      // streamed, the response can be larger than the available heap
+      HttpJsonStream json(request.server);
+      json.beginObject();
+      jsonGetDevices(json);
+      json.endObject();
+      json.end();
+      return HTTP_RESPONSE_SENT;
+    });
+  // readings grouped by sensor type, with their addresses or only the values
+  auto sensors = [this](bool detailedValues) {
+    return [this, detailedValues](RestRequest& request) {
+      HttpJsonStream json(request.server);
+      json.beginObject();
+      jsonForEachBySensorType(json, detailedValues);
+      json.endObject();
+      json.end();
+      return HTTP_RESPONSE_SENT;
+    };
+  };
+  on("/api/sensors")
+    .GET(sensors(true))
+    .GET("values", sensors(false));
   on("/api/dev/:xxx(string|integer)")
     .with(const_device_resolver)
     .GET(&Device::restDetail)
@@ -214,8 +239,9 @@ void Devices::setupRestHandler()
   on("/api/config/aliases")
     .GET([this](RestRequest& request) {
       // retrieve the alias file
-      String aliases = getAliasesFile();
-      request.server.send(200, "text/plain", aliases);
+      RequestArena::Text aliases(RequestScratch);
+      printAliasesFile(aliases);
+      request.server.send_P(200, "text/plain", aliases.c_str(), aliases.length());
       return HTTP_RESPONSE_SENT;
     })
     .POST([this](RestRequest& request) {
@@ -225,8 +251,9 @@ void Devices::setupRestHandler()
         saveAliasesFile(aliases.c_str());
 
       // re-read the aliase file back
-      aliases = getAliasesFile();
-      request.server.send(200, "text/plain", aliases);
+      RequestArena::Text reply(RequestScratch);
+      printAliasesFile(reply);
+      request.server.send_P(200, "text/plain", reply.c_str(), reply.length());
       return HTTP_RESPONSE_SENT;
     });
 }
@@ -241,7 +268,15 @@ short Devices::add(Device& dev)
     if(devices[i]==NULL) {
       devices[i] = &dev;
       dev.owner = this;
+      dev.ordinal = i;
       dev.begin();
+      schedulePush(&dev);
+      store.layout(devices, slots);
+
+      // index any aliases the device already has
+      aliasIndex.add(&dev, -1, dev.alias.c_str());
+      for(short s=0; s<dev.slotCount(); s++)
+        aliasIndex.add(&dev, s, dev.getSlotAlias(s).c_str());
       return i;
     }
   }
@@ -251,7 +286,12 @@ short Devices::add(Device& dev)
 void Devices::remove(short deviceId) {
   for(short i=0; i<slots; i++) {
     if(devices[i] && devices[i]->id == deviceId) {
+      scheduleRemove(devices[i]);
+      aliasIndex.remove(devices[i]);
+      devices[i]->ordinal = -1;
+      devices[i]->owner = NULL;
       devices[i] = NULL;
+      store.layout(devices, slots);
     }
   }
 }
@@ -259,7 +299,12 @@ void Devices::remove(short deviceId) {
 void Devices::remove(Device& dev) {
   for(short i=0; i<slots; i++) {
     if(devices[i] && devices[i] == &dev) {
+      scheduleRemove(devices[i]);
+      aliasIndex.remove(devices[i]);
+      devices[i]->ordinal = -1;
+      devices[i]->owner = NULL;
       devices[i] = NULL;
+      store.layout(devices, slots);
     }
   }
 }
@@ -280,24 +325,16 @@ Device& Devices::find(short deviceId)
   return NullDevice;
 }
 
-const Device& Devices::find(String deviceAlias) const
+const Device& Devices::find(const String& deviceAlias) const
 {
-  if(deviceAlias.length()!=0) {
-    for(short i=0; i<slots; i++) 
-      if(devices[i] && devices[i]->alias == deviceAlias)
-        return *devices[i];
-  }
-  return NullDevice;
+  const Device* dev = aliasIndex.findDevice(deviceAlias.c_str());
+  return dev ? *dev : NullDevice;
 }
 
-Device& Devices::find(String deviceAlias)
+Device& Devices::find(const String& deviceAlias)
 {
-  if(deviceAlias.length()!=0) {
-    for(short i=0; i<slots; i++) 
-      if(devices[i] && devices[i]->alias == deviceAlias)
-        return *devices[i];
-  }
-  return NullDevice;
+  Device* dev = aliasIndex.findDevice(deviceAlias.c_str());
+  return dev ? *dev : NullDevice;
 }
 
 SensorReading Devices::getReading(const SensorAddress& sa) const 
@@ -321,7 +358,7 @@ SensorReading Devices::getReading(short deviceId, unsigned short slotId) const
 
 Devices::ReadingIterator::ReadingIterator(Devices* _manager)
   : sensorTypeFilter(Invalid), valueTypeFilter(0), tsFrom(0), tsTo(0), 
-    device(NULL), slot(0), manager(_manager), singleDevice(false), deviceOrdinal(0)
+    device(NULL), slot(0), manager(_manager), singleDevice(false), deviceOrdinal(0), row(0), rowEnd(0), typeCursor(0), timeFiltered(false), historyPos(0), historyTs(0)
 {
 }
 
@@ -335,54 +372,79 @@ Devices::ReadingIterator& Devices::ReadingIterator::TimeBetween(unsigned long fr
 {
   tsFrom = from;
   tsTo = to;
+  timeFiltered = true;
   return *this;
 }
 
 Devices::ReadingIterator& Devices::ReadingIterator::Before(unsigned long ts)
 {
   tsTo = ts;
+  timeFiltered = true;
   return *this;
 }
 
 Devices::ReadingIterator& Devices::ReadingIterator::After(unsigned long ts)
 {
   tsFrom = (ts==0) ? 0 : ts-1;
+  timeFiltered = true;
   return *this;
 }
 
+bool Devices::ReadingIterator::matches(const SensorReading& r) const
+{
+  return r.timestamp >= tsFrom && (tsTo==0 || r.timestamp < tsTo);
+}
+
 SensorReading Devices::ReadingIterator::next()
 {
   if(manager==NULL)
     return InvalidReading;  // nothing to iterate
+  ReadingStore& store = manager->store;
   if(device ==NULL) {
     // get first device
     deviceOrdinal=0; slot=0;
     device = manager->devices[0];
+    while(device==NULL && ++deviceOrdinal < manager->slots)
+      device = manager->devices[deviceOrdinal];   // skip empty device slots
     if(device==NULL) {
       Serial.println("NoDevices");
       return InvalidReading;
     }
-  } else
-    slot++;
-
-  while(device !=NULL) {
-    // check if next slot is valid
-    while(slot < device->slotCount()) {
-      SensorReading r = (*device)[slot];
-      if(r.sensorType!=Invalid && r.valueType!=VT_INVALID &&
-        (sensorTypeFilter==Invalid || r.sensorType==sensorTypeFilter) &&
-        (valueTypeFilter==0 || r.valueType==valueTypeFilter) &&
-        (r.timestamp >= tsFrom && (tsTo==0 || r.timestamp < tsTo))) {
-          return r;
+    manager->publish();
+    row = store.first(deviceOrdinal);
+    rowEnd = store.rows();
+  } else if(historyPos == HistoryDone) {
+    // the previous reading returned was the current value of the slot
+    row++;
+    historyPos = 0;
+  }
+
+  // a slot whose current reading is older than the time filter has no newer history either
+  while((row = store.scan(row, rowEnd, sensorTypeFilter, valueTypeFilter, tsFrom, typeCursor)) < rowEnd) {
+    // rows of a device are consecutive and devices are in table order
+    while(row >= store.first(deviceOrdinal + 1))
+      deviceOrdinal++;
+    device = manager->devices[deviceOrdinal];
+    slot = row - store.first(deviceOrdinal);
+
+    // the columns only filter, a whole reading is copied faster from the device's own packed array
+    SensorReading r = (*(const Device*)device)[slot];
+    const SlotHistory* history = timeFiltered ? device->getHistory(slot) : NULL;
+    if(history) {
+      // past readings, the newest one recorded is the current reading so stop short of it
+      SensorReading h;
+      while(history->next(historyPos, historyTs, h) && h.timestamp < r.timestamp) {
+        if(matches(h))
+          return h;
       }
-      slot++;
     }
 
-    // must advance to next device
-    if(singleDevice)
-      return InvalidReading;  // only read from one device
-    device = manager->devices[++deviceOrdinal];
-    slot = 0;
+    if(matches(r)) {
+      historyPos = HistoryDone;
+      return r;
+    }
+    row++;
+    historyPos = 0;
   }
   return InvalidReading;  // end of readings
 }
@@ -400,6 +462,10 @@ Devices::ReadingIterator Devices::forEach(short deviceId)
       itr.deviceOrdinal = i;
       itr.device = devices[i];
       itr.singleDevice = true;
+      if(devices[i]->unpublished)
+        publish(*devices[i]);
+      itr.row = store.first(i);
+      itr.rowEnd = store.first(i + 1);
       return itr;
     }
   }
@@ -420,24 +486,163 @@ void Devices::clearAll()
       devices[i]->clear();
 }
 
-void Devices::handleUpdate()
+void Devices::publish()
+{
+  for(short i=0; i<slots; i++)
+    if(devices[i] && devices[i]->unpublished)
+      publish(*devices[i]);
+}
+
+void Devices::publish(Device& dev)
 {
-  unsigned long long _now = millis();
-  for(short n = slots; n>0; n--) {
-    Device* device = devices[update_iterator];
-    update_iterator = (update_iterator+1) % slots;  // rolling iterator
+  dev.unpublished = false;
+  if(dev.owner == this && dev.ordinal >= 0 && !store.publish(dev.ordinal, dev))
+    store.layout(devices, slots);   // the device changed its number of slots
+}
+
+void Devices::schedulePlace(short i, Device* dev)
+{
+  schedule[i] = dev;
+  dev->scheduleIndex = i;
+}
+
+bool Devices::scheduledBefore(const Device* a, const Device* b)
+{
+  // deadlines are compared by their difference so the order holds when millis() wraps
+  return (long)(a->nextUpdate - b->nextUpdate) < 0;
+}
+
+void Devices::scheduleUp(short i)
+{
+  Device* dev = schedule[i];
+  while(i > 0) {
+    short parent = (i-1) / 2;
+    if(!scheduledBefore(dev, schedule[parent]))
+      break;
+    schedulePlace(i, schedule[parent]);
+    i = parent;
+  }
+  schedulePlace(i, dev);
+}
 
-    if(device!=NULL && device->isStale(_now)) {
-        device->nextUpdate = _now + device->updateInterval;
-        device->handleUpdate();
-        return; // only handle one update at a time
+void Devices::scheduleDown(short i)
+{
+  Device* dev = schedule[i];
+  for(;;) {
+    short child = 2*i + 1;
+    if(child >= scheduled)
+      break;
+    if(child+1 < scheduled && scheduledBefore(schedule[child+1], schedule[child]))
+      child++;  // the earlier of the two children
+    if(!scheduledBefore(schedule[child], dev))
+      break;
+    schedulePlace(i, schedule[child]);
+    i = child;
+  }
+  schedulePlace(i, dev);
+}
+
+void Devices::schedulePush(Device* dev)
+{
+  if(dev->scheduleIndex >= 0 || scheduled >= slots)
+    return;   // already scheduled
+  schedulePlace(scheduled++, dev);
+  scheduleUp(dev->scheduleIndex);
+}
+
+void Devices::scheduleRemove(Device* dev)
+{
+  short i = dev->scheduleIndex;
+  if(i < 0 || i >= scheduled || schedule[i] != dev)
+    return;   // not in our schedule
+  dev->scheduleIndex = -1;
+
+  // move the last device into the hole and restore heap order
+  Device* last = schedule[--scheduled];
+  schedule[scheduled] = NULL;
+  if(last != dev) {
+    schedulePlace(i, last);
+    scheduleUp(i);
+    scheduleDown(last->scheduleIndex);
+  }
+}
+
+void Devices::reschedule(Device& dev)
+{
+  short i = dev.scheduleIndex;
+  if(i < 0 || i >= scheduled || schedule[i] != &dev)
+    return;   // not in our schedule, or being updated now and will be re-scheduled after
+  scheduleUp(i);
+  scheduleDown(dev.scheduleIndex);
+}
+
+unsigned long Devices::timeUntilNextUpdate(unsigned long _now) const
+{
+  if(scheduled == 0)
+    return NoUpdateScheduled;
+  if(_now==0)
+    _now = millis();
+  const Device* next = schedule[0];
+  return next->isStale(_now)
+    ? 0
+    : next->nextUpdate - _now + 1;  // devices are stale once now passes nextUpdate
+}
+
+void Devices::handleUpdate()
+{
+  unsigned long started = micros();
+  while(scheduled > 0) {
+    unsigned long _now = millis();
+    Device* device = schedule[0];
+    if(!device->isStale(_now))
+      return;   // earliest deadline is still in the future
+
+    // take the device out of the schedule while it updates, any delay() it requests takes effect when it goes back in
+    scheduleRemove(device);
+    Device::Statistics& stats = device->statistics;
+    if(device->nextUpdate > 0)
+      stats.latenessMillis.add(_now - device->nextUpdate);   // the first update has no deadline
+    device->nextUpdate = _now + device->updateInterval;
+    unsigned long updateStarted = micros();
+    device->handleUpdate();
+    if(device->owner == this) {
+      stats.updates++;
+      stats.updateMicros.add(micros() - updateStarted);
+      device->recordHistory();
+      device->unpublished = true;   // drivers may write their readings directly
+      schedulePush(device);
     }
+
+    if(micros() - started >= updateBudget)
+      return;   // out of time, remaining due devices are updated on the next call
   }
 }
 
+// collects printed text in a String
+class StringPrint : public Print
+{
+  public:
+    inline StringPrint(String& _s) : s(_s) {}
+    virtual size_t write(uint8_t c) { s += (char)c; return 1; }
+    virtual size_t write(const uint8_t *buffer, size_t n) { s.concat((const char*)buffer, n); return n; }
+    using Print::write;
+
+  protected:
+    String& s;
+};
+
 String Devices::getAliasesFile()
 {
+  HEAP_SCOPE(HeapAliases);
   String out;
+  StringPrint p(out);
+  printAliasesFile(p);
+  return out;
+}
+
+size_t Devices::printAliasesFile(Print& out)
+{
+  size_t n = 0;
   ReadingIterator itr = forEach();
   SensorReading r;
   Device* lastDev = NULL;
@@ -445,29 +650,30 @@ String Devices::getAliasesFile()
     if(lastDev != itr.device) {
       // check for device alias
       if(itr.device->alias.length()) {
-        out += itr.device->id;
-        out += '=';
-        out += itr.device->alias;
-        out += '\n';
+        n += out.print(itr.device->id);
+        n += out.print('=');
+        n += out.print(itr.device->alias);
+        n += out.print('\n');
       }
       lastDev = itr.device;
     }
     
-    String alias = itr.device->getSlotAlias(itr.slot);
+    const String& alias = itr.device->getSlotAlias(itr.slot);
     if(alias.length()) {
-        out += itr.device->id;
-        out += ':';
-        out += itr.slot;
-        out += '=';
-        out += alias;
-        out += '\n';
+        n += out.print(itr.device->id);
+        n += out.print(':');
+        n += out.print(itr.slot);
+        n += out.print('=');
+        n += out.print(alias);
+        n += out.print('\n');
     }
   }
-  return out;
+  return n;
 }
 
 int Devices::parseAliasesFile(const char* aliases)
 {
+  HEAP_SCOPE(HeapAliases);
   int parsed = 0;
   
   while(*aliases) {
@@ -541,7 +747,7 @@ int Devices::parseAliasesFile(const char* aliases)
           parsed++;
         } else {
           // set device alias
-          dev.alias = alias;
+          dev.setAlias(alias);
           parsed++;
         }
       }
@@ -551,6 +757,7 @@ int Devices::parseAliasesFile(const char* aliases)
 }
 
 int Devices::restoreAliasesFile() {
+  HEAP_SCOPE(HeapAliases);
   File f = SPIFFS.open("/aliases.txt", "r");
   if(f) {
     String aliases = f.readString();
@@ -564,6 +771,7 @@ int Devices::restoreAliasesFile() {
 
 bool Devices::saveAliasesFile(const char* aliases)
 {
+  HEAP_SCOPE(HeapAliases);
   File f = SPIFFS.open("/aliases.txt", "w");
   if(f) {
       f.print(aliases);
@@ -575,6 +783,7 @@ bool Devices::saveAliasesFile(const char* aliases)
 
 void Devices::jsonGetDevices(JsonObject& root)
 {
+  HEAP_SCOPE(HeapJson);
   // list all devices
   JsonArray devs = root.createNestedArray("devices");
   for(short i=0; i < slots; i++) {
@@ -603,7 +812,7 @@ void Devices::jsonGetDevices(JsonObject& root)
           JsonObject jslot = jslots.createNestedObject();
 
           // slot alias
-          String alias = device->getSlotAlias(j);
+          const String& alias = device->getSlotAlias(j);
           if(alias.length())
             jslot["alias"] = alias;
 
@@ -617,12 +826,13 @@ void Devices::jsonGetDevices(JsonObject& root)
 
 void Devices::jsonForEachBySensorType(JsonObject& root, ReadingIterator& itr, bool detailedValues)
 {
+  HEAP_SCOPE(HeapJson);
   SensorReading r;
-  JsonArray groups[LastSensorType];
+  JsonArray groups[LastSensorType + 1];
   //memset(groups, 0, sizeof(groups));
   
   while( (r = itr.next()) ) {
-    if(r.sensorType < FirstSensorType || r.sensorType >= LastSensorType)
+    if(r.sensorType < FirstSensorType || r.sensorType > LastSensorType)
       continue; // guard array bounds
     
     // get the group for this sensor
@@ -633,7 +843,9 @@ void Devices::jsonForEachBySensorType(JsonObject& root, ReadingIterator& itr, bo
     // add this sensor value
     if(detailedValues) {
       JsonObject jr = jgroup.createNestedObject();
-      jr["address"] = SensorAddress(itr.device->id, itr.slot).toString();
+      char address[READING_TEXT_SIZE];
+      SensorAddress(itr.device->id, itr.slot).formatTo(address, sizeof(address));
+      jr["address"] = (char*)address;   // a char* value is copied into the document
       r.toJson(jr, false);
     } else {
       r.addTo(jgroup);
@@ -641,6 +853,73 @@ void Devices::jsonForEachBySensorType(JsonObject& root, ReadingIterator& itr, bo
   }
 }
 
+void Devices::jsonGetDevices(JsonStream& json)
+{
+  HEAP_SCOPE(HeapJson);
+  // list all devices
+  json.beginArray("devices");
+  for(short i=0; i < slots; i++) {
+    if(devices[i]) {
+      Device* device = devices[i];
+      const char* driverName = device->getDriverName();
+      json.beginObject();
+      json.member("id", device->id);
+      if(driverName!=NULL)
+        json.member("driver", driverName);
+      if(device->alias.length())
+        json.member("alias", device->alias);
+
+      // device slot metadata
+      json.beginArray("slots");
+      for(int j=0, _j = device->slotCount(); j<_j; j++) {
+        const SensorReading& r = (*(const Device*)device)[j];
+        if(r) {
+          json.beginObject();
+          const String& alias = device->getSlotAlias(j);
+          if(alias.length())
+            json.member("alias", alias);
+          json.member("type", SensorTypeName(r.sensorType));
+          json.endObject();
+        }
+      }
+      json.endArray();
+      json.endObject();
+    }
+  }
+  json.endArray();
+}
+
+void Devices::jsonForEachBySensorType(JsonStream& json, bool detailedValues)
+{
+  HEAP_SCOPE(HeapJson);
+  // a stream cannot go back to add to an earlier group, so make one pass per sensor type over only its slots
+  SensorReading r;
+  for(short st=FirstSensorType; st <= LastSensorType; st++) {
+    ReadingIterator itr = forEach((SensorType)st);
+    bool opened = false;
+    while( (r = itr.next()) ) {
+      if(!opened) {
+        json.beginArray(SensorTypeName(r.sensorType));
+        opened = true;
+      }
+
+      // add this sensor value
+      if(detailedValues) {
+        json.beginObject();
+        char address[READING_TEXT_SIZE];
+        SensorAddress(itr.device->id, itr.slot).formatTo(address, sizeof(address));
+        json.member("address", (const char*)address);
+        r.toJson(json, false);
+        json.endObject();
+      } else {
+        r.addTo(json);
+      }
+    }
+    if(opened)
+      json.endArray();
+  }
+}
+
 #if 0
 void httpSend(ESP8266WebServer& server, short responseCode, const JsonObject& json)
 {
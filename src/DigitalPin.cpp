@@ -1,33 +1,155 @@
 #include "Motion.h"
 
 
-DigitalPin::DigitalPin(short id, SensorType _pinType, int _pin=0, unsigned long _updateInterval, bool _reversePolarity)
-  : Device(id, 1, _updateInterval), pinType(_pinType), pin(_pin), reversePolarity(_reversePolarity)
+DigitalPin::DigitalPin(short id, SensorType _pinType, int _pin, unsigned long _updateInterval, bool _reversePolarity, bool _captureEdges)
+  : Device(id, _captureEdges ? EdgeSlots : 1, _updateInterval), pinType(_pinType), pin(_pin), reversePolarity(_reversePolarity),
+    captureEdges(_captureEdges), attached(false), head(0), tail(0), overruns(0), overrunsSeen(0),
+    active(false), activeSince(0), pulseStart(0), onMicros(0), intervalStart(0), wasActive(false), pulses(0)
 {
     pinMode(pin, INPUT);
 }
 
 DigitalPin::DigitalPin(const DigitalPin& copy)
-  : Device(copy), pinType(copy.pinType), pin(copy.pin)
+  : Device(copy), pinType(copy.pinType), pin(copy.pin), reversePolarity(copy.reversePolarity),
+    captureEdges(copy.captureEdges), attached(false), head(0), tail(0), overruns(0), overrunsSeen(0),
+    active(false), activeSince(0), pulseStart(0), onMicros(0), intervalStart(0), wasActive(false), pulses(copy.pulses)
 {
 }
 
 DigitalPin& DigitalPin::operator=(const DigitalPin& copy)
 {
+  detach();
   Device::operator=(copy);
   pinType = copy.pinType;
   pin = copy.pin;
+  reversePolarity = copy.reversePolarity;
+  captureEdges = copy.captureEdges;
+  pulses = copy.pulses;
   return *this;
 }
 
+DigitalPin::~DigitalPin()
+{
+  detach();
+}
+
 const char* DigitalPin::getDriverName() const
 {
   return "gpio";
 }
 
-void DigitalPin::handleUpdate()
+void DigitalPin::begin()
+{
+  Device::begin();
+  if(captureEdges)
+    attach();
+}
+
+void DigitalPin::attach()
 {
+  if(attached)
+    return;
   bool v = digitalRead(pin) ? true : false;
-  (*this)[0] = SensorReading(pinType, reversePolarity ? !v : v);
+  active = reversePolarity ? !v : v;
+  head = tail = 0;
+  overruns = overrunsSeen = 0;
+  activeSince = pulseStart = intervalStart = micros();
+  onMicros = 0;
+  wasActive = active;
+  attachInterruptArg(digitalPinToInterrupt(pin), onEdge, this, CHANGE);
+  attached = true;
+}
+
+void DigitalPin::detach()
+{
+  if(attached) {
+    detachInterrupt(digitalPinToInterrupt(pin));
+    attached = false;
+  }
+}
+
+void ICACHE_RAM_ATTR DigitalPin::onEdge(void* arg)
+{
+  DigitalPin* dp = (DigitalPin*)arg;
+  unsigned short h = dp->head;
+  if((unsigned short)(h - dp->tail) >= DIGITAL_EDGE_QUEUE) {
+    dp->overruns++;
+    return;
+  }
+  Edge& e = dp->edges[h & (DIGITAL_EDGE_QUEUE - 1)];
+  e.at = micros();
+  e.level = digitalRead(dp->pin) ? true : false;
+  // the edge must be complete before the update can see it
+  __asm__ __volatile__ ("" ::: "memory");
+  dp->head = h + 1;
+}
+
+void DigitalPin::updateFromEdges()
+{
+  // edges are taken before the time so none of them is later than now
+  unsigned short h = head;
+  __asm__ __volatile__ ("" ::: "memory");
+  unsigned long now = micros();
+
+  unsigned short lost = overruns - overrunsSeen;
+  if(lost) {
+    overrunsSeen += lost;
+    statistics.errors.sensing += lost;
+  }
+
+  bool ended = false;
+  unsigned long pulseLength = 0, pulseEnd = 0;
+  for(unsigned short t = tail; t != h; t++) {
+    const Edge& e = edges[t & (DIGITAL_EDGE_QUEUE - 1)];
+    bool level = reversePolarity ? !e.level : e.level;
+    if(active) {
+      // the pulse ended, if the level is still active it went inactive and back too quickly to read
+      onMicros += e.at - activeSince;
+      ended = true;
+      pulseLength = e.at - pulseStart;
+      pulseEnd = e.at;
+    }
+    if(level || !active) {
+      // an active edge, or two inactive edges with a pulse too short to read between them
+      pulses++;
+      pulseStart = e.at;
+      wasActive = true;
+      if(!level) {
+        ended = true;
+        pulseLength = 0;
+        pulseEnd = e.at;
+      }
+    }
+    active = level;
+    activeSince = e.at;
+  }
+  tail = h;
+
+  if(active) {
+    onMicros += now - activeSince;
+    activeSince = now;
+  }
+
+  unsigned long ms = millis();
+  unsigned long elapsed = now - intervalStart;
+  (*this)[StateSlot] = SensorReading(pinType, wasActive || active);
+  (*this)[PulsesSlot] = SensorReading(Numeric, pulses);
+  if(ended)
+    (*this)[LastPulseSlot] = SensorReading(Milliseconds, 'l', ms - (now - pulseEnd) / 1000, (long)(pulseLength / 1000));
+  (*this)[OnRatioSlot] = SensorReading(Numeric, elapsed ? (float)onMicros / elapsed : (active ? 1.0f : 0.0f));
+
+  onMicros = 0;
+  intervalStart = now;
+  wasActive = active;
+}
+
+void DigitalPin::handleUpdate()
+{
+  if(attached)
+    updateFromEdges();
+  else {
+    bool v = digitalRead(pin) ? true : false;
+    (*this)[0] = SensorReading(pinType, reversePolarity ? !v : v);
+  }
   state = Nominal;
 }
@@ -1,5 +1,6 @@
 
 #include "Display.h"
+#include "HeapTelemetry.h"
 
 #include <ctype.h>
 #include <FS.h>   // Include the SPIFFS library
@@ -12,21 +13,29 @@ const char* ParseExceptionCodeToString(ParseExceptionCode code) {
     case InvalidRegister: return "invalid register"; break;
     case ExpectedRegister: return "expected register"; break;
     case ExpectedNumeric: return "expected number"; break;
+    case UnknownCommand: return "unknown command"; break;
     default: return "syntax error"; break;
   }
 }
 
 Display::Display(short id)
 	: Device(id, 0, 500, DF_DISPLAY), display(OLED_RESET), fonts(NULL), nfonts(0), pages(NULL), npages(6), activePage(0),
-	  G(0), D(0), S(0), _F(0), X(0), Y(0), U(0), P(1), R(0), T(0), C(0), W(0), H(0),
-	  w(0), str(NULL), gx(6), gy(9), relativeCoords(false)
+	  G(0), D(0), S(0), _F(0), X(0), Y(0), U(0), P(1), R(0), T(0), C(0), W(0), H(0), A(0), B(0),
+	  w(0), str(NULL), gx(6), gy(9), relativeCoords(false), drawn(NULL), ndrawn(0), redraw(true), panel(NULL), ntrends(0)
 {
-  pages = (DisplayPage*)calloc(npages, sizeof(DisplayPage));
+  pages = new DisplayPage[npages];
+  memset(trendChanged, 0, sizeof(trendChanged));
 }
 
 Display::~Display()
 {
-  ::free(pages);
+  delete[] pages;
+  if(drawn)
+    ::free(drawn);
+  if(panel)
+    ::free(panel);
+  for(short t=0; t<ntrends; t++)
+    delete trends[t];
 }
 
 const char* Display::getDriverName() const
@@ -38,10 +47,17 @@ void Display::begin()
 {
   #if (LCD == SSD1306)
   // Initiate the LCD and disply the Splash Screen
-  display.begin(SSD1306_SWITCHCAPVCC, 0x3C, false);  // initialize with the I2C addr 0x3C (for the 128x32)
+  display.begin(SSD1306_SWITCHCAPVCC, DISPLAY_I2C_ADDRESS, false);  // initialize with the I2C addr 0x3C (for the 128x32)
   display.ssd1306_command(SSD1306_SETCONTRAST);
   display.ssd1306_command(255); // Where arg is a value from 0 to 255 (sets contrast e.g. brightness)
   display.display();
+
+  // remember what the panel shows so later flushes only send what changed
+  size_t panelSize = display.width() * display.height() / 8;
+  if(panel == NULL)
+    panel = (uint8_t*)malloc(panelSize);
+  if(panel)
+    memcpy(panel, display.getBuffer(), panelSize);
   display.clearDisplay();
 #endif
 
@@ -55,17 +71,12 @@ void Display::begin()
 
 void Display::reset()
 {
-  G=D=S=_F=X=Y=W=H=U=R=T=C=w=0;
+  G=D=S=_F=X=Y=W=H=U=R=T=C=A=B=w=0;
   P=1;
   str = NULL;
   strLength=-1;
   gx = 6; gy = 9;
   relativeCoords = false;
-  display.clearDisplay();
-  display.setCursor(0,0);
-  display.setFont(NULL);
-  display.setTextColor(WHITE);
-  display.setTextSize(1);
 }
 
 short Display::addPage(const DisplayPage& page)
@@ -74,6 +85,7 @@ short Display::addPage(const DisplayPage& page)
     if(!pages[i].isValid()) {
       // use this page slot
       pages[i] = page;
+      compile(pages[i]);
       return i;
     }
   }
@@ -91,8 +103,20 @@ short Display::loadPageFromFS(short page_number)
   File f = SPIFFS.open(fname, "r");
   if(f) {
     String contents = f.readString();
-    pages[ page_number ] = DisplayPage(contents);
+    DisplayPage& page = pages[ page_number ];
+    page = DisplayPage(contents);
     f.close();
+
+    if(!compile(page)) {
+      const ParseException& pex = page.getError();
+      Serial.print(fname);
+      Serial.print(": ");
+      Serial.print(ParseExceptionCodeToString(pex.code));
+      Serial.print(" at line ");
+      Serial.print(pex.line+1);
+      Serial.print(" position ");
+      Serial.println(pex.position);
+    }
   }
   return page_number;
 }
@@ -128,7 +152,8 @@ short Display::loadAllPagesFromFS()
   short loaded=0;
   Dir dir = SPIFFS.openDir("/display/page");
   while (dir.next()) {
-    const char* id = strrchr(dir.fileName().c_str(), '/');
+    String fname = dir.fileName();
+    const char* id = strrchr(fname.c_str(), '/');
     if(id && isdigit(*++id)) {
       short n = atoi(id);
       if(loadPageFromFS(n) >=0)
@@ -142,12 +167,19 @@ short Display::loadAllPagesFromFS()
 
 void Display::handleUpdate()
 {
-  if(activePage>=0 && activePage<npages && pages[activePage].isValid()) {
-    ParseException pex;
-    execute(pages[activePage].code(), &pex);
+  // trends are kept up to date even while their page is not shown
+  feedTrends();
+
+  if(activePage>=0 && activePage<npages && pages[activePage].isCompiled()) {
+    // nothing to draw unless a reading or trend shown on the page changed
+    if(needsRedraw(pages[activePage]))
+      render(pages[activePage]);
     state = Nominal;
   } else
     state = Offline;
+
+  // a change to a trend of another page is seen when that page becomes active, which redraws it anyway
+  memset(trendChanged, 0, sizeof(trendChanged));
 }
 
 short& Display::getRegister(char reg)
@@ -166,17 +198,123 @@ short& Display::getRegister(char reg)
 		case 'R': return R;
     case 'T': return T;
 		case 'C': return C;
+		case 'A': return A;
+		case 'B': return B;
 		default: return w;
 	}
 }
 
-void Display::print(SensorReading r) {
+// true if two readings would be drawn the same
+static bool sameValue(const SensorReading& a, const SensorReading& b)
+{
+  if(a.valueType != b.valueType)
+    return false;
+  switch(a.valueType) {
+    case VT_NULL:
+    case VT_CLEAR:
+    case VT_INVALID: return true;
+    case VT_BOOL: return a.b == b.b;
+    default: return a.l == b.l;   // also compares the bits of a float
+  }
+}
+
+bool Display::needsRedraw(const DisplayPage& page)
+{
+  const DisplayInstruction* end = page.program + page.programLength;
+
+  // one remembered reading per reading instruction
+  short n = 0;
+  for(const DisplayInstruction* ins = page.program; ins < end; ins++)
+    if(ins->op == OpReading || ins->op == OpBar)
+      n++;
+  if(n != ndrawn) {
+    SensorReading* _drawn = (n > 0) ? (SensorReading*)realloc(drawn, n * sizeof(SensorReading)) : NULL;
+    if(n > 0 && _drawn == NULL)
+      return true;    // cannot track, always draw
+    if(n == 0 && drawn)
+      ::free(drawn);
+    drawn = _drawn;
+    ndrawn = n;
+    redraw = true;
+  }
+
+  bool changed = redraw;
+  SensorReading* prev = drawn;
+  for(const DisplayInstruction* ins = page.program; ins < end; ins++) {
+    if(ins->op == OpReading || ins->op == OpBar) {
+      SensorReading r = (owner!=NULL) ? owner->getReading(ins->a, ins->b) : NullReading;
+      if(changed || !sameValue(r, *prev)) {
+        *prev = r;
+        changed = true;
+      }
+      prev++;
+    } else if(ins->op == OpSparkline && ins->arg < ntrends && trendChanged[ins->arg])
+      changed = true;
+  }
+  redraw = false;
+  return changed;
+}
+
+void Display::flush()
+{
+  HEAP_SCOPE(HeapDisplay);
+  unsigned long started = micros();
+  sendChanges();
+  flushMicros.add(micros() - started);
+}
+
+void Display::sendChanges()
+{
+  if(panel == NULL) {
+    display.display();
+    return;
+  }
+
+  // send the changed span of each page of the framebuffer, one page is a row of bytes covering 8 pixel rows
+  uint8_t* buffer = display.getBuffer();
+  short width = display.width();
+  short npages = display.height() / 8;
+  for(short p=0; p<npages; p++) {
+    const uint8_t* row = buffer + p * width;
+    uint8_t* shown = panel + p * width;
+    short first = 0, last = width - 1;
+    while(first < width && row[first] == shown[first])
+      first++;
+    if(first == width)
+      continue;   // page unchanged
+    while(row[last] == shown[last])
+      last--;
+
+    display.ssd1306_command(SSD1306_PAGEADDR);
+    display.ssd1306_command(p);
+    display.ssd1306_command(p);
+    display.ssd1306_command(SSD1306_COLUMNADDR);
+    display.ssd1306_command(first);
+    display.ssd1306_command(last);
+    for(short c=first; c<=last; c+=DISPLAY_FLUSH_CHUNK) {
+      short n = last - c + 1;
+      if(n > DISPLAY_FLUSH_CHUNK)
+        n = DISPLAY_FLUSH_CHUNK;
+      Wire.beginTransmission(DISPLAY_I2C_ADDRESS);
+      Wire.write((uint8_t)0x40);   // data follows
+      Wire.write(row + c, n);
+      Wire.endTransmission();
+    }
+    memcpy(shown + first, row + first, last - first + 1);
+  }
+}
+
+void Display::print(const SensorReading& r, uint8_t precision) {
+  char text[READING_TEXT_SIZE];
   switch(r.valueType) {
     case VT_NULL: display.print("--"); break;
     case VT_CLEAR: break;
     case VT_INVALID: display.print("**"); break;
-    case VT_FLOAT: display.print(r.f, P); break;
-    case VT_INT: display.print(r.l); break;
+    case VT_FLOAT:
+    case VT_INT:
+      r.formatTo(text, sizeof(text), precision);
+      display.print(text);
+      break;
     case VT_BOOL: 
       if(r.b)
         display.fillCircle(display.getCursorX(), display.getCursorY()-4, 4, WHITE);
@@ -186,57 +324,255 @@ void Display::print(SensorReading r) {
   }
 }
 
+// the value of a reading as a number, false if the reading has no value
+static bool readingValue(const SensorReading& r, float& v)
+{
+  switch(r.valueType) {
+    case VT_FLOAT: v = r.f; return !isnan(r.f);
+    case VT_LONG: v = (float)r.l; return true;
+    case VT_BOOL: v = r.b ? 1 : 0; return true;
+    default: return false;
+  }
+}
+
+void Display::bar(FrameBuffer& fb, const SensorReading& r, short w, short h, short lo, short hi)
+{
+  short x = display.getCursorX(), y = display.getCursorY();
+  fb.rect(x, y, w, h);
+  if(w < 3 || h < 3)
+    return;
+
+  float v;
+  if(!readingValue(r, v))
+    return;   // only the outline for a missing reading
+  if(lo == hi) {
+    lo = 0;
+    hi = 100;
+  }
+
+  // fill the inside of the outline in proportion, left to right if wide or bottom up if tall
+  float frac = (v - lo) / (float)(hi - lo);
+  if(frac < 0) frac = 0;
+  if(frac > 1) frac = 1;
+  if(w >= h) {
+    short len = (short)(frac * (w - 2) + 0.5f);
+    fb.fillRect(x + 1, y + 1, len, h - 2);
+  } else {
+    short len = (short)(frac * (h - 2) + 0.5f);
+    fb.fillRect(x + 1, y + h - 1 - len, w - 2, len);
+  }
+}
+
+void Display::sparkline(FrameBuffer& fb, const TrendSeries& series, short h, short lo, short hi)
+{
+  if(h <= 0)
+    return;
+
+  // one column per bucket, scaled to fit the buckets unless given a range
+  float bmin, bmax, avg;
+  float vmin = lo, vmax = hi;
+  if(lo == hi) {
+    bool any = false;
+    for(unsigned short i=0; i<series.size(); i++) {
+      if(series.get(i, bmin, bmax, avg)) {
+        if(!any || bmin < vmin) vmin = bmin;
+        if(!any || bmax > vmax) vmax = bmax;
+        any = true;
+      }
+    }
+    if(!any)
+      return;
+  }
+  float scale = (vmax > vmin) ? (h - 1) / (vmax - vmin) : 0;
+
+  // each column spans the min to max of its bucket and reaches over to the average of the previous column so the
+  // trace is continuous, empty buckets leave a gap
+  short x = display.getCursorX(), bottom = display.getCursorY() + h - 1;
+  short prev = -1;
+  for(unsigned short i=0; i<series.size(); i++, x++) {
+    if(!series.get(i, bmin, bmax, avg)) {
+      prev = -1;
+      continue;
+    }
+    bmin = constrain(bmin, vmin, vmax);
+    bmax = constrain(bmax, vmin, vmax);
+    avg = constrain(avg, vmin, vmax);
+    short top = bottom - (short)((bmax - vmin) * scale + 0.5f);
+    short low = bottom - (short)((bmin - vmin) * scale + 0.5f);
+    if(prev >= 0) {
+      if(prev < top) top = prev + 1;
+      if(prev > low) low = prev - 1;
+    }
+    fb.vspan(x, top, low);
+    prev = bottom - (short)((avg - vmin) * scale + 0.5f);
+  }
+}
+
+void Display::feedTrends()
+{
+  if(owner == NULL)
+    return;
+  unsigned long now = millis();
+  for(short t=0; t<ntrends; t++) {
+    TrendSeries& series = *trends[t];
+    if(series.add(owner->getReading(series.deviceId, series.slot)))
+      trendChanged[t] = true;
+    if(series.advance(now))
+      trendChanged[t] = true;
+  }
+}
+
+void Display::bindTrends(DisplayPage* extra)
+{
+  bool used[DISPLAY_MAX_TRENDS];
+  memset(used, 0, sizeof(used));
+
+  // visits the sparklines of the loaded pages and the extra page with their width and period
+  auto forEachSparkline = [&](std::function<void(DisplayInstruction& ins, short w, unsigned long period)> fn) {
+    for(short p=0; p<npages || (p==npages && extra); p++) {
+      DisplayPage& pg = (p < npages) ? pages[p] : *extra;
+      short w = 0;
+      unsigned long period = 0;
+      for(short i=0; i<pg.programLength; i++) {
+        DisplayInstruction& ins = pg.program[i];
+        if(ins.op == OpBox)
+          w = ins.a;
+        else if(ins.op == OpPeriod)
+          period = (unsigned long)ins.a * 60000;
+        else if(ins.op == OpSparkline)
+          fn(ins, w, period);
+      }
+    }
+  };
+  auto find = [&](short deviceId, short slot, short w, unsigned long period) -> short {
+    for(short t=0; t<ntrends; t++)
+      if(trends[t]->matches(deviceId, slot, w, period))
+        return t;
+    return -1;
+  };
+
+  // drop the series no page refers to any more
+  forEachSparkline([&](DisplayInstruction& ins, short w, unsigned long period) {
+    short t = find(ins.a, ins.b, w, period);
+    if(t >= 0)
+      used[t] = true;
+  });
+  short n = 0;
+  for(short t=0; t<ntrends; t++) {
+    if(used[t])
+      trends[n++] = trends[t];
+    else
+      delete trends[t];
+  }
+  ntrends = n;
+  memset(trendChanged, 0, sizeof(trendChanged));
+
+  // bind each sparkline to its series, the index is stored in the instruction
+  forEachSparkline([&](DisplayInstruction& ins, short w, unsigned long period) {
+    short t = find(ins.a, ins.b, w, period);
+    if(t < 0 && ntrends < DISPLAY_MAX_TRENDS && w > 0) {
+      TrendSeries* series = new TrendSeries(ins.a, ins.b, w, period);
+      if(series->isValid()) {
+        t = ntrends;
+        trends[ntrends++] = series;
+      } else
+        delete series;
+    }
+    ins.arg = (t >= 0) ? (uint8_t)t : 0xff;
+  });
+}
+
 void Display::print(const char* str, short strLength) {
   while(strLength--)
     display.print(*str++);
 }
 
-bool Display::exec() 
+void Display::emit(DisplayPage& page, uint8_t op, short a, short b, uint8_t arg, const GFXfont* font)
+{
+  if(page.programLength >= page.programCapacity) {
+    short capacity = page.programCapacity ? page.programCapacity*2 : 16;
+    DisplayInstruction* program = (DisplayInstruction*)realloc(page.program, capacity * sizeof(DisplayInstruction));
+    if(program == NULL)
+      return;
+    page.program = program;
+    page.programCapacity = capacity;
+  }
+  DisplayInstruction& ins = page.program[page.programLength++];
+  ins.op = op;
+  ins.arg = arg;
+  ins.a = a;
+  ins.b = b;
+  ins.font = font;
+}
+
+bool Display::exec(DisplayPage& page, const char* code) 
 {
-  SensorReading r;
-  
 	switch(G) {
     case 0: // move to X,Y or R,C (does nothing since the XYRC regs already set the move)
       break;
     case 1: // draw string at R,C (text row/column)
-      print( str, strLength );
+      if(str != NULL)
+        emit(page, OpText, (short)(str - code), strLength);
       break;
 		case 2: // draw reading to X,Y
-      if(owner!=NULL)
-        print( owner->getReading(D, S) );
+      emit(page, OpReading, D, S, (uint8_t)constrain(P, 0, 255));
 		  break;
-    case 4: // draw line
+    case 4: // draw line from X,Y by W,H
+      emit(page, OpLine, W, H);
+      break;
+    case 5: // draw rect at X,Y of W,H
+      emit(page, OpRect, W, H);
       break;
-    case 5: // draw rect
     case 6: // fill rect
+      emit(page, OpFillRect, W, H);
+      break;
+    case 7: // draw circle at X,Y of radius U
+      emit(page, OpCircle, U);
       break;
-    case 7: // draw circle
     case 8: // fill circle
+      emit(page, OpFillCircle, U);
+      break;
+    case 9: // bar graph of reading D,S in W,H scaled from A to B
+      emit(page, OpBox, W, H);
+      emit(page, OpRange, A, B);
+      emit(page, OpBar, D, S);
+      break;
+    case 10: // sparkline of the last U minutes of reading D,S in W,H scaled from A to B, or to fit if A and B are equal
+      emit(page, OpBox, W, H);
+      emit(page, OpRange, A, B);
+      emit(page, OpPeriod, (U > 0) ? U : 10);
+      emit(page, OpSparkline, D, S, 0xff);
       break;
     case 50: // set grid size
       gx = W;
       gy = H;
+      break;
+    case 90: // absolute and relative coordinates, already applied when the register was set
+    case 91:
       break;
 		default:
-		  Serial.print("? G");
-		  Serial.println(G);
 		  return false;
 	}
 	return true;
 }
 
-bool Display::execute(const char* input, ParseException* _pex)
+bool Display::compile(DisplayPage& page)
 {
 	// we are ready for command processing
+	const char* code = page.code();
+	const char* input = code;
 	char c;
 	char reg = 0;
 	short* preg;
 	short line_reg_count=0; // the number of registers set on this line
 	bool negative;
 	short i = 0;
-	ParseException pex;
+	ParseException& pex = page.error;
 
+  page.clearProgram();
 	memset(&pex, 0, sizeof(ParseException));
+	if(input == NULL)
+	  return false;
 
   reset();
 
@@ -254,8 +590,10 @@ bool Display::execute(const char* input, ParseException* _pex)
       strLength = input - str;
 			continue;
 		} else if(c =='\n') {
-			if(line_reg_count>0)
-				exec();
+			if(line_reg_count>0 && !exec(page, code)) {
+			  pex.code = UnknownCommand;
+			  goto syntax_error;
+			}
 			pex.line++;
 			line_reg_count=0;
 			continue;
@@ -295,7 +633,8 @@ bool Display::execute(const char* input, ParseException* _pex)
 
 		// todo: check for floats
 
-		// set the register
+		// set the register, cursor moves take effect immediately since text printed on the line
+		// depends on them, the rest is applied when the line ends
 		*preg = i;
     switch(reg) {
       case 'G': // some G codes are instant
@@ -306,41 +645,33 @@ bool Display::execute(const char* input, ParseException* _pex)
         break;
       case 'R':
         if(G<80) {
-          if(relativeCoords)
-            display.setCursor(display.getCursorX(), (display.getCursorY()/gy)*gy + R*gy );
+          if(relativeCoords && gy)
+            emit(page, OpSnapY, gy, R*gy);
           else
-            display.setCursor(display.getCursorX(), R*gy);
+            emit(page, OpSetY, R*gy);
         }
         break;
       case 'C':
         if(G<80) {
-          if(relativeCoords)
-            display.setCursor((display.getCursorX()/gx)*gx + C*gx, display.getCursorY());
+          if(relativeCoords && gx)
+            emit(page, OpSnapX, gx, C*gx);
           else
-            display.setCursor(C*gx, display.getCursorY());
+            emit(page, OpSetX, C*gx);
         }
         break;
       case 'X':
-        if(G<80) {
-          if(relativeCoords)
-            display.setCursor(display.getCursorX() + X,display.getCursorY());
-          else
-            display.setCursor(X,display.getCursorY());
-        }
+        if(G<80)
+          emit(page, relativeCoords ? OpMoveX : OpSetX, X);
         break;
       case 'Y':
-        if(G<80) {
-          if(relativeCoords)
-            display.setCursor(display.getCursorX(),display.getCursorY() + Y);
-          else
-            display.setCursor(display.getCursorX(),Y);
-        }
+        if(G<80)
+          emit(page, relativeCoords ? OpMoveY : OpSetY, Y);
         break;
       case 'T':
-        display.setTextSize(T);
+        emit(page, OpTextSize, 0, 0, (uint8_t)T);
         break;
       case 'F':
-        display.setFont( 
+        emit(page, OpFont, 0, 0, 0,
           (fonts!=NULL && _F > 0 && _F <= nfonts) 
             ? fonts[_F-1].font
             : NULL
@@ -352,18 +683,97 @@ bool Display::execute(const char* input, ParseException* _pex)
 		line_reg_count++;
 	}
 
-	if(line_reg_count>0) {
+	if(line_reg_count>0 && !exec(page, code)) {
 		// must execute the last line
-		exec();
+		pex.code = UnknownCommand;
 	}
 
 syntax_error:
-  // can be error or not, we set PEX so caller gets line and position
-	if(_pex) *_pex = pex;
-  display.display();
+  // can be error or not, the page keeps the instructions up to the error
+  if(page.program == NULL)
+    emit(page, OpMoveX, 0);   // an empty page still draws a blank frame
+  else if(page.programLength < page.programCapacity) {
+    DisplayInstruction* program = (DisplayInstruction*)realloc(page.program, page.programLength * sizeof(DisplayInstruction));
+    if(program) {
+      page.program = program;
+      page.programCapacity = page.programLength;
+    }
+  }
+  bindTrends(&page);
+  redraw = true;
 	return pex.code==0;
 }
 
+void Display::compileAllPages()
+{
+  for(short i=0; i<npages; i++)
+    if(pages[i].isValid())
+      compile(pages[i]);
+}
+
+void Display::render(const DisplayPage& page)
+{
+  const char* code = page.code();
+  FrameBuffer fb(display.getBuffer(), display.width(), display.height());
+  short x, y, w = 0, h = 0, lo = 0, hi = 0;
+
+  display.clearDisplay();
+  display.setCursor(0,0);
+  display.setFont(NULL);
+  display.setTextColor(WHITE);
+  display.setTextSize(1);
+
+  const DisplayInstruction* ins = page.program;
+  const DisplayInstruction* end = ins + page.programLength;
+  for(; ins < end; ins++) {
+    switch(ins->op) {
+      case OpSetX: display.setCursor(ins->a, display.getCursorY()); break;
+      case OpSetY: display.setCursor(display.getCursorX(), ins->a); break;
+      case OpMoveX: display.setCursor(display.getCursorX() + ins->a, display.getCursorY()); break;
+      case OpMoveY: display.setCursor(display.getCursorX(), display.getCursorY() + ins->a); break;
+      case OpSnapX: display.setCursor((display.getCursorX()/ins->a)*ins->a + ins->b, display.getCursorY()); break;
+      case OpSnapY: display.setCursor(display.getCursorX(), (display.getCursorY()/ins->a)*ins->a + ins->b); break;
+      case OpTextSize: display.setTextSize(ins->arg); break;
+      case OpFont: display.setFont(ins->font); break;
+      case OpText: print(code + ins->a, ins->b); break;
+      case OpReading:
+        if(owner!=NULL)
+          print(owner->getReading(ins->a, ins->b), ins->arg);
+        break;
+      case OpLine:
+        x = display.getCursorX();
+        y = display.getCursorY();
+        fb.line(x, y, x + ins->a, y + ins->b);
+        break;
+      case OpRect: fb.rect(display.getCursorX(), display.getCursorY(), ins->a, ins->b); break;
+      case OpFillRect: fb.fillRect(display.getCursorX(), display.getCursorY(), ins->a, ins->b); break;
+      case OpCircle: fb.circle(display.getCursorX(), display.getCursorY(), ins->a); break;
+      case OpFillCircle: fb.fillCircle(display.getCursorX(), display.getCursorY(), ins->a); break;
+      case OpBox: w = ins->a; h = ins->b; break;
+      case OpRange: lo = ins->a; hi = ins->b; break;
+      case OpBar:
+        if(owner!=NULL)
+          bar(fb, owner->getReading(ins->a, ins->b), w, h, lo, hi);
+        break;
+      case OpSparkline:
+        if(ins->arg < ntrends)
+          sparkline(fb, *trends[ins->arg], h, lo, hi);
+        break;
+    }
+  }
+  flush();
+}
+
+bool Display::execute(const char* input, ParseException* pex)
+{
+  DisplayPage page(input, false);
+  bool ok = compile(page);
+  render(page);
+  bindTrends();     // release the series only this page used
+	if(pex) *pex = page.getError();
+	return ok;
+}
+
 void Display::httpPageGetFonts() {
   String s('[');
   for(short i=0; i < nfonts; i++) {
@@ -382,6 +792,7 @@ void Display::httpPageSetActivePage() {
   int n = pageN.toInt();
   if(n>=0 && n < npages) {
     activePage = n;
+    redraw = true;
     server.send(200, "text/plain", String("{ page: ")+n+" }");
   } else
     server.send(400, "text/pain", "invalid page");
@@ -407,8 +818,17 @@ void Display::httpPageSetCode() {
   String fs = server.arg("fs");
   String code = server.arg("plain");
   if(n>=0 && n < npages) {
+    DisplayPage newPage( code.c_str() );
+    if(!compile(newPage)) {
+      // reject the page, the current page stays in place
+      const ParseException& pex = newPage.getError();
+      server.send(400, "text/plain", String(ParseExceptionCodeToString(pex.code))+" at line "+(pex.line+1)+" position "+pex.position);
+      bindTrends();
+      return;
+    }
     DisplayPage& page = pages[n];
-    page = DisplayPage( code.c_str() );
+    page = newPage;
+    bindTrends();     // keeps the series of the new page, drops those only the old page used
     if(fs!="false" && page.isValid())
       savePageToFS( n );
     server.send(200, "text/plain", page.code());
@@ -420,27 +840,27 @@ void Display::httpPageSetCode() {
 
 
 DisplayPage::DisplayPage()
-  : _code(NULL), owns_mem(false)
+  : _code(NULL), owns_mem(false), program(NULL), programLength(0), programCapacity(0)
 {
+  memset(&error, 0, sizeof(error));
 }
 
 DisplayPage::DisplayPage(String p)
-  : _code(strdup(p.c_str())), owns_mem(true)
+  : _code(strdup(p.c_str())), owns_mem(true), program(NULL), programLength(0), programCapacity(0)
 {
+  memset(&error, 0, sizeof(error));
 }
 
 DisplayPage::DisplayPage(const char* code, bool copy_mem)
-  : _code(copy_mem ? strdup(code) : code), owns_mem(copy_mem)
+  : _code(copy_mem ? strdup(code) : code), owns_mem(copy_mem), program(NULL), programLength(0), programCapacity(0)
 {
+  memset(&error, 0, sizeof(error));
 }
 
 DisplayPage::DisplayPage(const DisplayPage& copy)
-  : _code(copy._code), owns_mem(copy.owns_mem)
+  : _code(NULL), owns_mem(false), program(NULL), programLength(0), programCapacity(0)
 {
-  // we must copy the memory if our source owns the memory as it may free it
-  if(owns_mem) {
-    _code = strdup(copy._code);
-  }
+  *this = copy;
 }
 
 DisplayPage::~DisplayPage()
@@ -453,15 +873,38 @@ void DisplayPage::clear()
   if(owns_mem && _code) {
     ::free((void*)_code);
   }
+  _code = NULL;
+  owns_mem = false;
+  clearProgram();
+}
+
+void DisplayPage::clearProgram()
+{
+  if(program)
+    ::free(program);
+  program = NULL;
+  programLength = programCapacity = 0;
 }
 
 DisplayPage& DisplayPage::operator=(const DisplayPage& copy)
 {
+  if(this == &copy)
+    return *this;
   clear();  // ensure we dont already own memory
   _code = copy._code;
   owns_mem = copy.owns_mem;
   if(owns_mem) {
     _code = strdup(copy._code);
   }
+
+  // instructions refer to text by offset into the code so they stay valid in the copy
+  error = copy.error;
+  if(copy.program) {
+    program = (DisplayInstruction*)malloc(copy.programLength * sizeof(DisplayInstruction));
+    if(program) {
+      memcpy(program, copy.program, copy.programLength * sizeof(DisplayInstruction));
+      programLength = programCapacity = copy.programLength;
+    }
+  }
   return *this;
 }
@@ -0,0 +1,103 @@
+#include "FlowMeter.h"
+
+
+FlowMeter::FlowMeter(short id, int pin, float _kFactor, unsigned long _updateInterval)
+  : DigitalPin(id, Flow, pin, _updateInterval), kFactor(_kFactor > 0 ? _kFactor : FLOW_K_FACTOR), frequency(0),
+    count(0), lastPulse(0), snapshots(0), newest(0)
+{
+  alloc(FlowSlots);
+}
+
+const char* FlowMeter::getDriverName() const
+{
+  return "flow";
+}
+
+void FlowMeter::setKFactor(float k)
+{
+  if(k > 0)
+    kFactor = k;
+}
+
+void FlowMeter::begin()
+{
+  DigitalPin::begin();
+  if(!attached) {
+    lastPulse = micros();
+    attachInterruptArg(digitalPinToInterrupt(pin), onPulse, this, reversePolarity ? FALLING : RISING);
+    attached = true;
+  }
+}
+
+void ICACHE_RAM_ATTR FlowMeter::onPulse(void* arg)
+{
+  FlowMeter* fm = (FlowMeter*)arg;
+  fm->lastPulse = micros();
+  // the time is written before the count, a reader that sees the count unchanged also has the matching time
+  __asm__ __volatile__ ("" ::: "memory");
+  fm->count = fm->count + 1;
+}
+
+FlowMeter::Snapshot FlowMeter::sample() const
+{
+  Snapshot s;
+  do {
+    s.count = count;
+    __asm__ __volatile__ ("" ::: "memory");
+    s.lastPulse = lastPulse;
+    __asm__ __volatile__ ("" ::: "memory");
+  } while(s.count != count);
+  s.at = micros();
+  return s;
+}
+
+unsigned long FlowMeter::getPulses() const
+{
+  return count;
+}
+
+float FlowMeter::estimate(const Snapshot& now) const
+{
+  // walk back from the newest snapshot until enough pulses have passed
+  const Snapshot* from = NULL;
+  for(short i=0; i<snapshots; i++) {
+    const Snapshot& s = window[(newest - i + FLOW_WINDOW) % FLOW_WINDOW];
+    from = &s;
+    if(now.count - s.count >= FLOW_MIN_PULSES)
+      break;
+  }
+  if(from == NULL || now.count == from->count)
+    return 0;
+
+  // whole periods between the last pulse seen by each snapshot
+  unsigned long n = now.count - from->count;
+  unsigned long start = from->lastPulse;
+  if(from->at - start > 2 * ((now.lastPulse - start) / n)) {
+    // there was no flow when the older snapshot was taken, its last pulse does not start a period
+    start = from->at;
+  }
+  if(now.lastPulse == start)
+    return 0;
+  float hz = (float)n * 1000000.0f / (float)(now.lastPulse - start);
+
+  // the next pulse is overdue when flow slows or stops, the frequency is at most one pulse since the last one
+  unsigned long since = now.at - now.lastPulse;
+  if(since > 0 && 1000000.0f / since < hz)
+    hz = 1000000.0f / since;
+  return hz;
+}
+
+void FlowMeter::handleUpdate()
+{
+  Snapshot now = sample();
+  frequency = estimate(now);
+  newest = (newest + 1) % FLOW_WINDOW;
+  window[newest] = now;
+  if(snapshots < FLOW_WINDOW)
+    snapshots++;
+
+  (*this)[RateSlot] = SensorReading(Flow, frequency * 60.0f / kFactor);
+  (*this)[VolumeSlot] = SensorReading(Numeric, now.count / kFactor);
+  (*this)[FrequencySlot] = SensorReading(Numeric, frequency);
+  state = Nominal;
+}
@@ -0,0 +1,197 @@
+#include "FrameBuffer.h"
+
+
+void FrameBuffer::pixel(short x, short y, uint8_t color)
+{
+  if(x < 0 || x >= width || y < 0 || y >= height)
+    return;
+  apply(buffer[x + (y >> 3) * width], (uint8_t)(1 << (y & 7)), color);
+}
+
+void FrameBuffer::hspan(short x0, short x1, short y, uint8_t color)
+{
+  if(x0 > x1) { short t = x0; x0 = x1; x1 = t; }
+  if(y < 0 || y >= height || x1 < 0 || x0 >= width)
+    return;
+  if(x0 < 0) x0 = 0;
+  if(x1 >= width) x1 = width - 1;
+
+  // the same bit of consecutive bytes in one page
+  uint8_t mask = (uint8_t)(1 << (y & 7));
+  uint8_t* p = buffer + (y >> 3) * width + x0;
+  for(short n = x1 - x0 + 1; n > 0; n--)
+    apply(*p++, mask, color);
+}
+
+void FrameBuffer::vspan(short x, short y0, short y1, uint8_t color)
+{
+  if(y0 > y1) { short t = y0; y0 = y1; y1 = t; }
+  if(x < 0 || x >= width || y1 < 0 || y0 >= height)
+    return;
+  if(y0 < 0) y0 = 0;
+  if(y1 >= height) y1 = height - 1;
+
+  // whole bytes for the pages in between, partial masks at either end
+  uint8_t* p = buffer + (y0 >> 3) * width + x;
+  uint8_t first = (uint8_t)(0xff << (y0 & 7));
+  uint8_t last = (uint8_t)(0xff >> (7 - (y1 & 7)));
+  short pages = (y1 >> 3) - (y0 >> 3);
+  if(pages == 0) {
+    apply(*p, first & last, color);
+    return;
+  }
+  apply(*p, first, color);
+  for(p += width; --pages > 0; p += width)
+    apply(*p, 0xff, color);
+  apply(*p, last, color);
+}
+
+void FrameBuffer::line(short x0, short y0, short x1, short y1, uint8_t color)
+{
+  if(y0 == y1) {
+    hspan(x0, x1, y0, color);
+    return;
+  }
+  if(x0 == x1) {
+    vspan(x0, y0, y1, color);
+    return;
+  }
+
+  // Bresenham along the major axis, pixels in a run along the major axis are drawn as one span
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  short t;
+  if(steep) {
+    t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if(x0 > x1) {
+    t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+  short dx = x1 - x0;
+  short dy = abs(y1 - y0);
+  short err = dx / 2;
+  short ystep = (y0 < y1) ? 1 : -1;
+  short run = x0;
+  for(; x0 <= x1; x0++) {
+    err -= dy;
+    if(err < 0 || x0 == x1) {
+      if(steep)
+        vspan(y0, run, x0, color);
+      else
+        hspan(run, x0, y0, color);
+      run = x0 + 1;
+      if(err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+}
+
+void FrameBuffer::rect(short x, short y, short w, short h, uint8_t color)
+{
+  if(w <= 0 || h <= 0)
+    return;
+  hspan(x, x + w - 1, y, color);
+  if(h > 1)
+    hspan(x, x + w - 1, y + h - 1, color);
+  if(h > 2) {
+    vspan(x, y + 1, y + h - 2, color);
+    if(w > 1)
+      vspan(x + w - 1, y + 1, y + h - 2, color);
+  }
+}
+
+void FrameBuffer::fillRect(short x, short y, short w, short h, uint8_t color)
+{
+  if(w <= 0 || h <= 0)
+    return;
+  short x1 = x + w - 1, y1 = y + h - 1;
+  if(x1 < 0 || x >= width || y1 < 0 || y >= height)
+    return;
+  if(x < 0) x = 0;
+  if(y < 0) y = 0;
+  if(x1 >= width) x1 = width - 1;
+  if(y1 >= height) y1 = height - 1;
+
+  // one mask per page applied across the columns
+  for(short page = y >> 3; page <= (y1 >> 3); page++) {
+    uint8_t mask = 0xff;
+    if(page == (y >> 3))
+      mask &= (uint8_t)(0xff << (y & 7));
+    if(page == (y1 >> 3))
+      mask &= (uint8_t)(0xff >> (7 - (y1 & 7)));
+    uint8_t* p = buffer + page * width + x;
+    for(short n = x1 - x + 1; n > 0; n--)
+      apply(*p++, mask, color);
+  }
+}
+
+void FrameBuffer::circle(short cx, short cy, short r, uint8_t color)
+{
+  if(r < 0)
+    return;
+  short f = 1 - r;
+  short ddx = 1, ddy = -2 * r;
+  short x = 0, y = r;
+
+  pixel(cx, cy + r, color);
+  pixel(cx, cy - r, color);
+  pixel(cx + r, cy, color);
+  pixel(cx - r, cy, color);
+  while(x < y) {
+    if(f >= 0) {
+      y--;
+      ddy += 2;
+      f += ddy;
+    }
+    x++;
+    ddx += 2;
+    f += ddx;
+
+    pixel(cx + x, cy + y, color);
+    pixel(cx - x, cy + y, color);
+    pixel(cx + x, cy - y, color);
+    pixel(cx - x, cy - y, color);
+    pixel(cx + y, cy + x, color);
+    pixel(cx - y, cy + x, color);
+    pixel(cx + y, cy - x, color);
+    pixel(cx - y, cy - x, color);
+  }
+}
+
+void FrameBuffer::fillCircle(short cx, short cy, short r, uint8_t color)
+{
+  if(r < 0)
+    return;
+
+  // midpoint circle, filled with vertical spans which are the cheap direction in page layout
+  vspan(cx, cy - r, cy + r, color);
+  short f = 1 - r;
+  short ddx = 1, ddy = -2 * r;
+  short x = 0, y = r;
+  short px = x, py = y;
+  while(x < y) {
+    if(f >= 0) {
+      y--;
+      ddy += 2;
+      f += ddy;
+    }
+    x++;
+    ddx += 2;
+    f += ddx;
+
+    // each column is filled once, from the octant that reaches it first
+    if(x < y + 1) {
+      vspan(cx + x, cy - y, cy + y, color);
+      vspan(cx - x, cy - y, cy + y, color);
+    }
+    if(y != py) {
+      vspan(cx + py, cy - px, cy + px, color);
+      vspan(cx - py, cy - px, cy + px, color);
+      py = y;
+    }
+    px = x;
+  }
+}
@@ -0,0 +1,225 @@
+#include "HeapTelemetry.h"
+#include "JsonStream.h"
+
+
+// marks a block allocated through track(), the low byte holds the tag
+#define HEAP_MAGIC      0xB10C0000UL
+#define HEAP_MAGIC_MASK 0xFFFFFF00UL
+
+const char* HeapTagName(HeapTag tag)
+{
+  switch(tag) {
+    case HeapUntagged: return "untagged";
+    case HeapWeb: return "web";
+    case HeapJson: return "json";
+    case HeapDevices: return "devices";
+    case HeapAliases: return "aliases";
+    case HeapDisplay: return "display";
+    case HeapInflux: return "influx";
+    default: return "unknown";
+  }
+}
+
+namespace HeapTelemetry {
+
+  struct Header {
+    uint32_t magic;     // HEAP_MAGIC | tag
+    uint32_t size;      // bytes requested
+  };
+  static_assert(sizeof(Header) == HeaderSize, "header size must keep blocks 8 byte aligned");
+
+  static HeapTag tag = HeapUntagged;
+  static TagCounters tags[HeapTagCount];
+  static long liveBytes = 0;
+
+#if defined(HEAP_TELEMETRY)
+  static Sample history[HEAP_SAMPLES];
+  static short nsamples = 0;
+  static short head = 0;              // where the next sample goes
+  static unsigned long nextSample = 0;
+#endif
+
+  bool enabled()
+  {
+#if defined(HEAP_TELEMETRY)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  HeapTag currentTag()
+  {
+    return tag;
+  }
+
+  HeapTag setTag(HeapTag _tag)
+  {
+    HeapTag previous = tag;
+    tag = _tag;
+    return previous;
+  }
+
+  const TagCounters& counters(HeapTag t)
+  {
+    return tags[(t >= 0 && t < HeapTagCount) ? t : HeapUntagged];
+  }
+
+  void* track(void* block, size_t size, HeapTag t)
+  {
+    if(t < 0 || t >= HeapTagCount)
+      t = HeapUntagged;
+    Header* h = (Header*)block;
+    h->magic = HEAP_MAGIC | (uint32_t)t;
+    h->size = (uint32_t)size;
+
+    TagCounters& c = tags[t];
+    c.allocations++;
+    c.liveBlocks++;
+    c.liveBytes += size;
+    if(c.liveBytes > c.peakBytes)
+      c.peakBytes = c.liveBytes;
+    liveBytes += size;
+    return h + 1;
+  }
+
+  void* untrack(void* ptr, size_t* size, HeapTag* t)
+  {
+    Header* h = (Header*)ptr - 1;
+    if((h->magic & HEAP_MAGIC_MASK) != HEAP_MAGIC || (h->magic & 0xff) >= HeapTagCount)
+      return NULL;    // not allocated by track()
+
+    HeapTag blockTag = (HeapTag)(h->magic & 0xff);
+    TagCounters& c = tags[blockTag];
+    c.frees++;
+    c.liveBlocks--;
+    c.liveBytes -= h->size;
+    liveBytes -= h->size;
+    if(size) *size = h->size;
+    if(t) *t = blockTag;
+    h->magic = 0;     // a second free of the block is not counted again
+    return h;
+  }
+
+  Sample sample()
+  {
+    Sample s;
+    s.timestamp = millis();
+    s.free = ESP.getFreeHeap();
+    s.largestBlock = ESP.getMaxFreeBlockSize();
+    s.fragmentation = ESP.getHeapFragmentation();
+    s.liveBytes = liveBytes;
+    return s;
+  }
+
+  void handle()
+  {
+#if defined(HEAP_TELEMETRY)
+    if((long)(millis() - nextSample) < 0)
+      return;
+    nextSample = millis() + HEAP_SAMPLE_INTERVAL;
+    history[head] = sample();
+    head = (head + 1) % HEAP_SAMPLES;
+    if(nsamples < HEAP_SAMPLES)
+      nsamples++;
+#endif
+  }
+
+  void toJson(JsonStream& json)
+  {
+    Sample now = sample();
+    json.member("enabled", enabled());
+    json.member("free", (unsigned long)now.free);
+    json.member("largestBlock", (unsigned long)now.largestBlock);
+    json.member("fragmentation", (int)now.fragmentation);
+
+#if defined(HEAP_TELEMETRY)
+    json.member("liveBytes", now.liveBytes);
+    json.beginObject("tags");
+    for(short t=0; t<HeapTagCount; t++) {
+      const TagCounters& c = tags[t];
+      json.beginObject(HeapTagName((HeapTag)t));
+      json.member("allocations", c.allocations);
+      json.member("frees", c.frees);
+      json.member("liveBlocks", c.liveBlocks);
+      json.member("liveBytes", c.liveBytes);
+      json.member("peakBytes", c.peakBytes);
+      json.endObject();
+    }
+    json.endObject();
+
+    // oldest sample first, each sample is [timestamp, free, largestBlock, fragmentation, liveBytes]
+    json.beginObject("history");
+    json.member("interval", (unsigned long)HEAP_SAMPLE_INTERVAL);
+    json.beginArray("samples");
+    for(short i=0; i<nsamples; i++) {
+      const Sample& s = history[(head - nsamples + i + HEAP_SAMPLES) % HEAP_SAMPLES];
+      json.beginArray();
+      json.value(s.timestamp);
+      json.value((unsigned long)s.free);
+      json.value((unsigned long)s.largestBlock);
+      json.value((int)s.fragmentation);
+      json.value(s.liveBytes);
+      json.endArray();
+    }
+    json.endArray();
+    json.endObject();
+#endif
+  }
+}
+
+
+#if defined(HEAP_TELEMETRY) && !defined(NIMBLE_HOST)
+// the ESP8266 allocator, wrapped by linking with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t n, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+  void __real_free(void* ptr);
+
+  void* __wrap_malloc(size_t size)
+  {
+    void* block = __real_malloc(size + HeapTelemetry::HeaderSize);
+    return block ? HeapTelemetry::track(block, size, HeapTelemetry::currentTag()) : NULL;
+  }
+
+  void* __wrap_calloc(size_t n, size_t size)
+  {
+    if(size > 0 && n > ((size_t)-1 - HeapTelemetry::HeaderSize) / size)
+      return NULL;
+    void* block = __real_calloc(1, n * size + HeapTelemetry::HeaderSize);
+    return block ? HeapTelemetry::track(block, n * size, HeapTelemetry::currentTag()) : NULL;
+  }
+
+  void __wrap_free(void* ptr)
+  {
+    if(ptr == NULL)
+      return;
+    void* block = HeapTelemetry::untrack(ptr);
+    __real_free(block ? block : ptr);
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size)
+  {
+    if(ptr == NULL)
+      return __wrap_malloc(size);
+    if(size == 0) {
+      __wrap_free(ptr);
+      return NULL;
+    }
+
+    size_t old;
+    HeapTag tag;
+    void* block = HeapTelemetry::untrack(ptr, &old, &tag);
+    if(block == NULL)
+      return __real_realloc(ptr, size);   // allocated before or around the wrapper
+
+    void* resized = __real_realloc(block, size + HeapTelemetry::HeaderSize);
+    if(resized == NULL) {
+      HeapTelemetry::track(block, old, tag);    // the old block is untouched
+      return NULL;
+    }
+    return HeapTelemetry::track(resized, size, tag);
+  }
+}
+#endif
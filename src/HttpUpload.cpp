@@ -0,0 +1,180 @@
+#include "HttpUpload.h"
+
+
+HttpUpload::HttpUpload()
+  : state(Idle), port(80), contentType("text/plain"), headerLength(0), payload(NULL), length(0), sent(0),
+    statusLength(0), connectTimeout(HTTP_UPLOAD_CONNECT_TIMEOUT), stepTimeout(HTTP_UPLOAD_STEP_TIMEOUT), deadline(0),
+    backoffMin(HTTP_UPLOAD_BACKOFF_MIN), backoffMax(HTTP_UPLOAD_BACKOFF_MAX), backoff(HTTP_UPLOAD_BACKOFF_MIN),
+    retryAt(0), backingOff(false)
+{
+  host[0] = 0;
+}
+
+bool HttpUpload::begin(const char* url, const char* _contentType)
+{
+  abort();
+  host[0] = 0;
+  contentType = _contentType;
+  if(strncmp(url, "http://", 7) != 0)
+    return false;
+
+  // http://host[:port][/path]
+  const char* h = url + 7;
+  size_t n = strcspn(h, ":/");
+  if(n == 0 || n >= sizeof(host))
+    return false;
+  memcpy(host, h, n);
+  host[n] = 0;
+  h += n;
+  port = 80;
+  if(*h == ':') {
+    port = (uint16_t)atoi(h + 1);
+    h += strcspn(h, "/");
+  }
+  path = (*h == '/') ? h : "/";
+  return true;
+}
+
+void HttpUpload::setTimeouts(unsigned long connectMs, unsigned long stepMs)
+{
+  connectTimeout = connectMs;
+  stepTimeout = stepMs;
+}
+
+void HttpUpload::setBackoff(unsigned long minMs, unsigned long maxMs)
+{
+  backoffMin = minMs;
+  backoffMax = (maxMs > minMs) ? maxMs : minMs;
+  backoff = backoffMin;
+}
+
+unsigned long HttpUpload::backoffRemaining() const
+{
+  long remaining = (long)(retryAt - millis());
+  return (backingOff && remaining > 0) ? (unsigned long)remaining : 0;
+}
+
+bool HttpUpload::ready() const
+{
+  return state == Idle && host[0] != 0 && backoffRemaining() == 0;
+}
+
+bool HttpUpload::start(const uint8_t* _payload, size_t _length)
+{
+  if(!ready())
+    return false;
+  int n = snprintf(header, sizeof(header),
+      "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+      path.c_str(), host, contentType, (unsigned int)_length);
+  if(n <= 0 || n >= (int)sizeof(header))
+    return false;
+  headerLength = n;
+  payload = _payload;
+  length = _length;
+  sent = 0;
+  statusLength = 0;
+  state = Connecting;
+  return true;
+}
+
+void HttpUpload::abort()
+{
+  if(state != Idle)
+    client.stop();
+  state = Idle;
+  payload = NULL;
+}
+
+int HttpUpload::finish(int status)
+{
+  client.stop();
+  state = Idle;
+  payload = NULL;
+  if(status >= 200 && status < 300) {
+    backoff = backoffMin;
+    backingOff = false;
+  } else {
+    retryAt = millis() + backoff;
+    backingOff = true;
+    backoff = (backoff < backoffMax / 2) ? backoff * 2 : backoffMax;
+  }
+  return status;
+}
+
+int HttpUpload::handle()
+{
+  switch(state) {
+    case Idle:
+      return 0;
+
+    case Connecting:
+      client.setTimeout(connectTimeout);
+      if(!client.connect(host, port))
+        return finish(HTTPC_ERROR_CONNECTION_REFUSED);
+      client.setNoDelay(true);
+      state = Sending;
+      deadline = millis() + stepTimeout;
+      return 0;
+
+    case Sending:
+      return send();
+
+    case Receiving:
+      return receive();
+  }
+  return 0;
+}
+
+int HttpUpload::send()
+{
+  if(!client.connected())
+    return finish(HTTPC_ERROR_CONNECTION_LOST);
+
+  size_t room = client.availableForWrite();
+  while(room > 0 && sent < headerLength + length) {
+    const uint8_t* p;
+    size_t n;
+    if(sent < headerLength) {
+      p = (const uint8_t*)header + sent;
+      n = headerLength - sent;
+    } else {
+      p = payload + (sent - headerLength);
+      n = length - (sent - headerLength);
+    }
+    if(n > room)
+      n = room;
+    n = client.write(p, n);
+    if(n == 0)
+      break;
+    sent += n;
+    room -= n;
+  }
+
+  if(sent == headerLength + length) {
+    state = Receiving;
+    deadline = millis() + stepTimeout;
+  } else if((long)(millis() - deadline) >= 0)
+    return finish(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+  return 0;
+}
+
+int HttpUpload::receive()
+{
+  // the status line is HTTP/1.1 204 No Content, only the status is needed
+  int c;
+  while(client.available() > 0 && (c = client.read()) >= 0) {
+    if(c == '\n') {
+      statusLine[statusLength] = 0;
+      const char* code = strchr(statusLine, ' ');
+      return finish((code && atoi(code + 1) > 0) ? atoi(code + 1) : HTTPC_ERROR_NO_HTTP_SERVER);
+    }
+    if(statusLength < (short)sizeof(statusLine) - 1)
+      statusLine[statusLength++] = (char)c;
+  }
+
+  if(!client.connected())
+    return finish(HTTPC_ERROR_CONNECTION_LOST);
+  if((long)(millis() - deadline) >= 0)
+    return finish(HTTPC_ERROR_READ_TIMEOUT);
+  return 0;
+}
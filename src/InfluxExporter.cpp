@@ -0,0 +1,295 @@
+#include "InfluxExporter.h"
+#include "Devices.h"
+#include "Device.h"
+
+namespace {
+  // appends line protocol text to a buffer, ok is cleared once something did not fit
+  class LineWriter
+  {
+    public:
+      char* p;
+      char* end;
+      bool ok;
+
+      inline LineWriter(char* buf, size_t n) : p(buf), end(buf + n), ok(true) {}
+
+      inline void put(char c) {
+        if(p < end) *p++ = c;
+        else ok = false;
+      }
+
+      inline void text(const char* s) {
+        while(*s) put(*s++);
+      }
+
+      inline void text(const char* s, size_t n) {
+        while(n--) put(*s++);
+      }
+
+      // tag keys and values escape commas, equal signs and spaces
+      void tag(const char* s) {
+        for(; *s; s++) {
+          if(*s==',' || *s=='=' || *s==' ')
+            put('\\');
+          put(*s);
+        }
+      }
+
+      void number(unsigned long long v) {
+        char digits[20];
+        short n = 0;
+        do {
+          digits[n++] = '0' + (char)(v % 10);
+          v /= 10;
+        } while(v > 0);
+        while(n > 0)
+          put(digits[--n]);
+      }
+
+      void number(long v) {
+        if(v < 0) {
+          put('-');
+          number((unsigned long long)-(long long)v);
+        } else
+          number((unsigned long long)v);
+      }
+  };
+}
+
+InfluxExporter::InfluxExporter(Devices& _manager, NTPClient& _ntp)
+  : manager(_manager), ntp(_ntp), inFlight(false), measurement(NULL), site(NULL),
+    buffer(NULL), batchSize(0), depth(0), order(NULL), lengths(NULL), points(NULL), first(0), queued(0),
+    interval(INFLUX_INTERVAL), nextExport(0), collected(0)
+{
+}
+
+InfluxExporter::~InfluxExporter()
+{
+  release();
+}
+
+void InfluxExporter::release()
+{
+  upload.abort();
+  inFlight = false;
+  if(buffer) free(buffer);
+  if(order) free(order);
+  if(lengths) free(lengths);
+  if(points) free(points);
+  buffer = NULL;
+  order = NULL;
+  lengths = NULL;
+  points = NULL;
+  depth = 0;
+  first = queued = 0;
+}
+
+bool InfluxExporter::begin(const char* server, const char* database, const char* _measurement, const char* _site,
+                           unsigned short _batchSize, unsigned short _depth)
+{
+  release();
+  measurement = _measurement;
+  site = _site;
+
+  String url = server;
+  if(url.indexOf(':', url.indexOf("//") + 2) < 0)
+    url += ":8086";
+  url += "/write?precision=ms&db=";
+  url += database;
+  if(!upload.begin(url.c_str()))
+    return false;
+
+  if(_batchSize == 0 || _depth < 2)
+    return false;   // one batch is always being filled
+  batchSize = _batchSize;
+  buffer = (char*)malloc((size_t)batchSize * _depth);
+  order = (unsigned short*)malloc(_depth * sizeof(unsigned short));
+  lengths = (unsigned short*)calloc(_depth, sizeof(unsigned short));
+  points = (unsigned short*)calloc(_depth, sizeof(unsigned short));
+  if(buffer == NULL || order == NULL || lengths == NULL || points == NULL) {
+    release();
+    return false;
+  }
+  depth = _depth;
+  for(unsigned short i=0; i<depth; i++)
+    order[i] = i;
+
+  // only readings taken from now on are exported
+  collected = millis();
+  nextExport = collected + interval;
+  return true;
+}
+
+unsigned short InfluxExporter::pending() const
+{
+  return (depth > 0 && lengths[filling()] > 0) ? queued + 1 : queued;
+}
+
+void InfluxExporter::handle()
+{
+  if(depth == 0)
+    return;
+  if((long)(millis() - nextExport) >= 0) {
+    nextExport = millis() + interval;
+    collect();
+    flush();
+  }
+
+  int status = upload.handle();
+  if(status != 0) {
+    // the oldest batch finished uploading
+    inFlight = false;
+    statistics.lastStatus = status;
+    if(status >= 200 && status < 300) {
+      statistics.posts++;
+      discard();
+    } else {
+      statistics.failures++;
+      if(status >= 400 && status < 500 && status != 408 && status != 429) {
+        // the server rejected the batch itself, sending it again would block every later batch
+        unsigned short b = at(0);
+        statistics.dropped++;
+        statistics.droppedPoints += points[b];
+        discard();
+      }
+    }
+  }
+
+  if(!inFlight && queued > 0 && WiFi.status() == WL_CONNECTED)
+    inFlight = upload.start((const uint8_t*)buffer + (size_t)at(0) * batchSize, lengths[at(0)]);
+}
+
+size_t InfluxExporter::formatPoint(char* buf, size_t n, const Device& device, unsigned short slot,
+                                   const SensorReading& r, unsigned long long epochMs) const
+{
+  LineWriter out(buf, n);
+  out.tag(measurement);
+  out.text(",site=");
+  out.tag(site);
+
+  out.text(",device=");
+  const String& deviceAlias = device.alias;
+  if(deviceAlias.length() > 0)
+    out.tag(deviceAlias.c_str());
+  else
+    out.number((long)device.id);
+
+  out.text(",slot=");
+  const String& slotAlias = device.getSlotAlias(slot);
+  if(slotAlias.length() > 0)
+    out.tag(slotAlias.c_str());
+  else
+    out.number((long)slot);
+
+  out.text(",type=");
+  out.tag(SensorTypeName(r.sensorType));
+
+  out.text(" value=");
+  switch(r.valueType) {
+    case 'i':
+    case 'l':
+      out.number(r.l);
+      out.put('i');
+      break;
+    case 'f': {
+      // 9 significant digits is the full precision of a float, large and tiny values use an exponent
+      char text[READING_TEXT_SIZE];
+      int len = snprintf(text, sizeof(text), "%.9g", (double)r.f);
+      if(len <= 0 || len >= (int)sizeof(text))
+        return 0;
+      out.text(text, len);
+      break;
+    }
+    case 'b':
+      out.text(r.b ? "true" : "false");
+      break;
+  }
+
+  out.put(' ');
+  out.number(epochMs);
+  out.put('\n');
+  return out.ok ? out.p - buf : 0;
+}
+
+bool InfluxExporter::write(const Device& device, unsigned short slot, const SensorReading& r, unsigned long long epochMs)
+{
+  for(short attempt = 0; attempt < 2; attempt++) {
+    unsigned short b = filling();
+    size_t n = formatPoint(buffer + (size_t)b * batchSize + lengths[b], batchSize - lengths[b], device, slot, r, epochMs);
+    if(n > 0) {
+      lengths[b] += n;
+      points[b]++;
+      statistics.points++;
+      return true;
+    }
+    if(lengths[b] == 0)
+      return false;   // point is larger than a whole batch
+    queue();
+  }
+  return false;
+}
+
+void InfluxExporter::queue()
+{
+  if(queued + 1 >= depth) {
+    // ring is full, drop the oldest batch or the one after it if the oldest is being uploaded
+    unsigned short drop = inFlight ? 1 : 0;
+    unsigned short b = at(drop);
+    statistics.dropped++;
+    statistics.droppedPoints += points[b];
+    lengths[b] = points[b] = 0;
+    if(drop == queued)
+      return;   // only the uploading batch is queued, the batch being filled was dropped
+
+    // the dropped batch becomes the next batch to fill, the uploading batch stays where it is in memory
+    order[(first + drop) % depth] = order[first];
+    order[first] = b;
+    first = (first + 1) % depth;
+    queued--;
+  }
+  queued++;
+  unsigned short b = filling();
+  lengths[b] = points[b] = 0;
+}
+
+unsigned int InfluxExporter::collect()
+{
+  if(depth == 0)
+    return 0;
+  unsigned long epoch = ntp.getEpochTime();
+  unsigned long now = millis();
+  if(epoch < TIMESTAMP_MIN)
+    return 0;   // no wall clock time yet, readings wait until there is
+  unsigned long long nowMs = (unsigned long long)epoch * 1000;
+
+  // readings taken at now are left for the next collect so none are sent twice
+  unsigned int n = 0;
+  Devices::ReadingIterator itr = manager.forEach().TimeBetween(collected, now);
+  SensorReading r;
+  while( (r = itr.next()) ) {
+    if(r.sensorType < FirstSensorType)
+      continue;   // configuration values are not measurements
+    if(r.valueType == 'f' && !isfinite(r.f))
+      continue;   // line protocol has no nan or inf
+    if(r.valueType != 'f' && r.valueType != 'l' && r.valueType != 'i' && r.valueType != 'b')
+      continue;
+    if(write(*itr.device, itr.slot, r, nowMs - (now - r.timestamp)))
+      n++;
+  }
+  collected = now;
+  return n;
+}
+
+void InfluxExporter::discard()
+{
+  unsigned short b = at(0);
+  lengths[b] = points[b] = 0;
+  first = (first + 1) % depth;
+  queued--;
+}
+
+void InfluxExporter::flush()
+{
+  if(depth > 0 && lengths[filling()] > 0)
+    queue();
+}
@@ -0,0 +1,209 @@
+#include "JsonStream.h"
+
+
+JsonStream::JsonStream()
+  : length(0), total(0), hasMembers(0), depth(0), afterKey(false)
+{
+}
+
+void JsonStream::flush()
+{
+  if(length > 0) {
+    write(buffer, length);
+    total += length;
+    length = 0;
+  }
+}
+
+void JsonStream::put(char c)
+{
+  if(length >= sizeof(buffer))
+    flush();
+  buffer[length++] = c;
+}
+
+void JsonStream::put(const char* s, size_t n)
+{
+  while(n > 0) {
+    if(length >= sizeof(buffer))
+      flush();
+    size_t chunk = sizeof(buffer) - length;
+    if(chunk > n)
+      chunk = n;
+    memcpy(buffer + length, s, chunk);
+    length += chunk;
+    s += chunk;
+    n -= chunk;
+  }
+}
+
+void JsonStream::putString(const char* s)
+{
+  static const char* hex = "0123456789abcdef";
+  put('"');
+  const char* run = s;    // copy runs of plain characters in one go
+  for(; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if(c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    put(run, s - run);
+    run = s + 1;
+    put('\\');
+    switch(c) {
+      case '"': put('"'); break;
+      case '\\': put('\\'); break;
+      case '\n': put('n'); break;
+      case '\r': put('r'); break;
+      case '\t': put('t'); break;
+      default:
+        put("u00", 3);
+        put(hex[c >> 4]);
+        put(hex[c & 0xf]);
+    }
+  }
+  put(run, s - run);
+  put('"');
+}
+
+void JsonStream::putNumber(long long v)
+{
+  char digits[24];
+  char* p = digits + sizeof(digits);
+  unsigned long long u = (v < 0) ? -(unsigned long long)v : (unsigned long long)v;
+  do {
+    *--p = (char)('0' + u % 10);
+    u /= 10;
+  } while(u);
+  if(v < 0)
+    *--p = '-';
+  put(p, digits + sizeof(digits) - p);
+}
+
+void JsonStream::separate()
+{
+  if(afterKey) {
+    afterKey = false;
+    return;
+  }
+  uint32_t bit = (uint32_t)1 << depth;
+  if(hasMembers & bit)
+    put(',');
+  hasMembers |= bit;
+}
+
+void JsonStream::open(char c, const char* k)
+{
+  if(k)
+    key(k);
+  separate();
+  put(c);
+  if(depth < JSON_STREAM_DEPTH-1)
+    depth++;
+  hasMembers &= ~((uint32_t)1 << depth);
+}
+
+void JsonStream::close(char c)
+{
+  put(c);
+  if(depth > 0)
+    depth--;
+}
+
+void JsonStream::beginObject(const char* k) { open('{', k); }
+void JsonStream::endObject() { close('}'); }
+void JsonStream::beginArray(const char* k) { open('[', k); }
+void JsonStream::endArray() { close(']'); }
+
+void JsonStream::key(const char* k)
+{
+  separate();
+  putString(k);
+  put(':');
+  afterKey = true;
+}
+
+void JsonStream::value(const char* s)
+{
+  if(s == NULL) {
+    null();
+    return;
+  }
+  separate();
+  putString(s);
+}
+
+void JsonStream::value(const String& s) { value(s.c_str()); }
+void JsonStream::value(int v) { separate(); putNumber(v); }
+void JsonStream::value(unsigned int v) { separate(); putNumber(v); }
+void JsonStream::value(long v) { separate(); putNumber(v); }
+void JsonStream::value(unsigned long v) { separate(); putNumber(v); }
+void JsonStream::value(double v) { value((float)v); }
+
+void JsonStream::value(bool v)
+{
+  separate();
+  if(v)
+    put("true", 4);
+  else
+    put("false", 5);
+}
+
+void JsonStream::null()
+{
+  separate();
+  put("null", 4);
+}
+
+void JsonStream::value(float v)
+{
+  if(isnan(v) || isinf(v) || v > 9e14f || v < -9e14f) {
+    null();   // not representable as a Json number in fixed point
+    return;
+  }
+
+  // fixed point with up to 4 decimals, trailing zeros are dropped
+  separate();
+  long long scaled = (long long)((v < 0) ? v * 10000.0 - 0.5 : v * 10000.0 + 0.5);
+  if(scaled < 0) {
+    put('-');
+    scaled = -scaled;
+  }
+  putNumber(scaled / 10000);
+  int frac = (int)(scaled % 10000);
+  if(frac) {
+    char digits[5] = { '.' };
+    int n = 1;
+    for(int div = 1000; frac && div; div /= 10) {
+      digits[n++] = (char)('0' + frac / div);
+      frac %= div;
+    }
+    put(digits, n);
+  }
+}
+
+
+HttpJsonStream::HttpJsonStream(ESP8266WebServer& server, int code)
+  : response(server, code, "application/json")
+{
+}
+
+HttpJsonStream::~HttpJsonStream()
+{
+  end();
+}
+
+void HttpJsonStream::end()
+{
+  flush();
+  response.end();
+}
+
+void HttpJsonStream::write(const char* text, size_t n)
+{
+  response.write((const uint8_t*)text, n);
+}
+
+void PrintJsonStream::write(const char* text, size_t n)
+{
+  out.write((const uint8_t*)text, n);
+}
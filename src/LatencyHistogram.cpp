@@ -0,0 +1,105 @@
+#include "LatencyHistogram.h"
+#include "JsonStream.h"
+
+
+#define SUB_BUCKETS   (1 << LATENCY_SUB_BITS)
+
+LatencyHistogram::LatencyHistogram()
+{
+  clear();
+}
+
+void LatencyHistogram::clear()
+{
+  n = 0;
+  lo = hi = 0;
+  sum = 0;
+  memset(buckets, 0, sizeof(buckets));
+}
+
+unsigned short LatencyHistogram::bucketOf(unsigned long value)
+{
+  if(value < SUB_BUCKETS)
+    return (unsigned short)value;
+
+  // the top bit selects the power of two, the bits below it the bucket within it
+  short e = 31 - __builtin_clz((uint32_t)value);
+  unsigned long b = ((unsigned long)(e - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + ((value >> (e - LATENCY_SUB_BITS)) & (SUB_BUCKETS - 1));
+  return (b < LATENCY_BUCKETS) ? (unsigned short)b : LATENCY_BUCKETS - 1;
+}
+
+unsigned long LatencyHistogram::bucketLimit(unsigned short bucket)
+{
+  if(bucket < SUB_BUCKETS)
+    return bucket;
+  short e = (bucket >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+  unsigned long width = 1UL << (e - LATENCY_SUB_BITS);
+  return ((unsigned long)(SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1))) << (e - LATENCY_SUB_BITS)) + width - 1;
+}
+
+void LatencyHistogram::add(unsigned long value)
+{
+  if(value > 0xffffffffUL)
+    value = 0xffffffffUL;
+  if(n == 0 || value < lo)
+    lo = value;
+  if(value > hi)
+    hi = value;
+  n++;
+  sum += value;
+
+  unsigned short& b = buckets[bucketOf(value)];
+  if(b == 0xffff) {
+    for(short i=0; i<LATENCY_BUCKETS; i++)
+      buckets[i] = (buckets[i] + 1) / 2;
+  }
+  b++;
+}
+
+unsigned long LatencyHistogram::percentile(float fraction) const
+{
+  unsigned long total = 0;
+  for(short i=0; i<LATENCY_BUCKETS; i++)
+    total += buckets[i];
+  if(total == 0)
+    return 0;
+
+  unsigned long rank = (unsigned long)(fraction * total + 0.5f);
+  if(rank < 1)
+    rank = 1;
+  unsigned long seen = 0;
+  for(short i=0; i<LATENCY_BUCKETS; i++) {
+    seen += buckets[i];
+    if(seen >= rank) {
+      unsigned long v = bucketLimit(i);
+      if(v > hi) v = hi;
+      if(v < lo) v = lo;
+      return v;
+    }
+  }
+  return hi;
+}
+
+void LatencyHistogram::toJson(JsonObject& target) const
+{
+  target["count"] = n;
+  if(n == 0)
+    return;
+  target["min"] = min();
+  target["max"] = max();
+  target["mean"] = mean();
+  target["p50"] = percentile(0.5f);
+  target["p99"] = percentile(0.99f);
+}
+
+void LatencyHistogram::toJson(JsonStream& json) const
+{
+  json.member("count", n);
+  if(n == 0)
+    return;
+  json.member("min", min());
+  json.member("max", max());
+  json.member("mean", mean());
+  json.member("p50", percentile(0.5f));
+  json.member("p99", percentile(0.99f));
+}
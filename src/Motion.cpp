@@ -1,7 +1,8 @@
 #include "Motion.h"
 
+// short PIR pulses are caught by the edge interrupt, so updates need not poll for them
 MotionIR::MotionIR(short id, int pin)
-  : DigitalPin(id, Motion, pin, 250)
+  : DigitalPin(id, Motion, pin, 1000, false, true)
 {
 }
 
@@ -21,7 +21,6 @@ const char* password = SSID_PASSWORD;
 #endif
 
 
-bool enable_influx = false;
 const char* influx_server = INFLUX_SERVER;
 const char* influx_database = INFLUX_DATABASE;
 const char* influx_measurement = INFLUX_MEASUREMENT;
@@ -40,6 +39,16 @@ const char* influx_measurement = INFLUX_MEASUREMENT;
 #include <AutoConnectCredential.h>
 #endif
 
+// If set, loop() sleeps until the next device update is due instead of spinning. The sleep is capped at
+// IDLE_MAX_SLEEP milliseconds so web requests are still answered promptly, and after a request the loop stays
+// awake for IDLE_AWAKE_AFTER_REQUEST milliseconds since requests tend to arrive in bursts (page, css, api calls).
+#define IDLE_SLEEP
+#define IDLE_MAX_SLEEP            50
+#define IDLE_AWAKE_AFTER_REQUEST  250
+
+// If set, the WiFi modem light-sleeps while loop() is idle. Saves more power but adds latency to requests.
+//#define IDLE_LIGHT_SLEEP
+
 #define ENABLE_DHT
 //#define ENABLE_MOISTURE
 //#define ENABLE_MOTION
@@ -47,12 +56,24 @@ const char* influx_measurement = INFLUX_MEASUREMENT;
 
 
 #include "Devices.h"
+#include "ChunkedResponse.h"
 #include "Motion.h"
+#include "FlowMeter.h"
 #include "AnalogPin.h"
 #include "DHTSensor.h"
 #include "OneWireSensors.h"
 #include "Display.h"
 #include "AtlasScientific.h"
+#include "InfluxExporter.h"
+#include "LatencyHistogram.h"
+#include "JsonStream.h"
+#include "HeapTelemetry.h"
+#include "RequestArena.h"
+
+#if defined(NIMBLE_HOST)
+#include "NimbleHost.h"
+#include "SimulatedDevice.h"
+#endif
 
 #include <Restfully.h>
 
@@ -84,8 +105,6 @@ const FontInfo display_fonts[] = {
 };
 Display* display;
 
-#define TIMESTAMP_MIN  1500000000   // time must be greater than this to be considered NTP valid time
-
 typedef enum {
   JsonName,
   JsonValue,
@@ -103,6 +122,10 @@ ESP8266WebServer server(80);
 WiFiUDP ntpUDP;
 NTPClient ntp(ntpUDP);
 
+#if defined(ENABLE_INFLUX)
+InfluxExporter influx(DeviceManager, ntp);
+#endif
+
 
 #if defined(CAPTIVE_PORTAL)
 AutoConnect Portal(server);
@@ -144,68 +167,66 @@ bool handleFileRead(String path) { // send the right file to the client (if it e
 }
 
 void handleRoot() {
-  String html = "<html><head><title>Wireless Wall SensorInfo</title>";
-  html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-  html += "<link rel='stylesheet' href='css/nimble.css'>";
-  html += "<meta http-equiv=\"refresh\" content=\"30\">";
-  html += "</head>";
-  html += "<body>";
+  ChunkedResponse html(server, 200, "text/html");
+  html.print("<html><head><title>Wireless Wall SensorInfo</title>");
+  html.print("<meta name='viewport' content='width=device-width, initial-scale=1'>");
+  html.print("<link rel='stylesheet' href='css/nimble.css'>");
+  html.print("<meta http-equiv=\"refresh\" content=\"30\">");
+  html.print("</head>");
+  html.print("<body>");
   // header
-  html += "<div class='header'><h1>Nimble Sensor</h1><span class='copyright'>Copyright 2018, Flying Einstein LLC</span></div>";
+  html.print("<div class='header'><h1>Nimble Sensor</h1><span class='copyright'>Copyright 2018, Flying Einstein LLC</span></div>");
   // title area 
-  html += "<div class='title'><h2><label>Site</label> ";
-  html += hostname;
-  html += "</h2></div>";
-
-  html += "<div class='tiles'>";
-
-  // enumerate through all sensor types, and then iterate all sensors of that type
-  // so that sensors of the same group are grouped together
-  SensorReading r;
-  for(short dt=FirstSensorType; dt <= LastSensorType; dt++) {
-    Devices::ReadingIterator itr = DeviceManager.forEach((SensorType)dt);
-    short n = 0;
-    String typeName = SensorTypeName((SensorType)dt);
-    
+  html.print("<div class='title'><h2><label>Site</label> ");
+  html.print(hostname);
+  html.print("</h2></div>");
+
+  html.print("<div class='tiles'>");
+
+  // sensors of the same type are grouped together, each group only visits the slots of its type
+  for(short st=FirstSensorType; st<=LastSensorType; st++) {
+    const char* typeName = SensorTypeName((SensorType)st);
+    bool opened = false;
+    SensorReading r;
+    Devices::ReadingIterator itr = DeviceManager.forEach((SensorType)st);
     while( (r = itr.next()) ) {
-      if(n==0) {
+      if(!opened) {
         // first device, add a header
-        html += "<div class='sensors'><h3>";
-        html += typeName;
-        html += "</h3>";
+        html.print("<div class='sensors'><h3>");
+        html.print(typeName);
+        html.print("</h3>");
+        opened = true;
       }
 
-      html += "<div id='";
-      html += typeName;
-      html += "' class='sensor'>";
+      html.print("<div id='");
+      html.print(typeName);
+      html.print("' class='sensor'>");
 
-      String alias = itr.device->getSlotAlias(itr.slot);
+      const String& alias = itr.device->getSlotAlias(itr.slot);
       if(alias.length()) {
-        html += "<label class='alias'>";
-        html += alias;
-        html += "</label>";
+        html.print("<label class='alias'>");
+        html.print(alias);
+        html.print("</label>");
       }
-      
-      html += "<span>";
-      html += r.toString();
-      html += "</span>";      
-      
-      html += "<label class='address'>";
-      html += itr.device->id;
-      html += ':';
-      html += itr.slot;
-      html += "</label>";
-      
-      html += "</div>";
-      n++;
-    }
 
-    if(n>0)
-      html += "</div>"; // closing tag for the group
+      html.print("<span>");
+      r.printTo(html);
+      html.print("</span>");
+
+      html.print("<label class='address'>");
+      html.print(itr.device->id);
+      html.print(':');
+      html.print(itr.slot);
+      html.print("</label>");
+
+      html.print("</div>");
+    }
+    if(opened)
+      html.print("</div>"); // closing tag for the group
   }
 
-  html += "</div></body></html>";
-  server.send(200, "text/html", html);
+  html.print("</div></body></html>");
+  html.end();
 }
 
 void handleNotFound() {
@@ -223,6 +244,136 @@ void handleNotFound() {
   server.send(404, "text/plain", message);
 }
 
+/*** Idle Loop
+
+*/
+struct {
+  unsigned long iterations;       // number of loop() iterations
+  unsigned long idleIterations;   // iterations that ended in a sleep
+  unsigned long long idleMicros;  // total time spent sleeping
+  unsigned long lastRequest;      // millis() timestamp of the most recent web request
+} loopStats;
+
+// time taken by each phase of loop() in microseconds, the display flush is timed by the display itself
+struct {
+  LatencyHistogram http;
+  LatencyHistogram ntp;
+  LatencyHistogram devices;
+  LatencyHistogram influx;
+  LatencyHistogram busy;          // the whole loop() iteration except the idle sleep
+} loopTiming;
+
+// sees every web request first and records the activity, but never handles the request itself
+class ActivityRequestHandler : public RequestHandler
+{
+    virtual bool canHandle(HTTPMethod method, String uri) {
+      loopStats.lastRequest = millis();
+      return false;
+    }
+    virtual bool handle(ESP8266WebServer& server, HTTPMethod requestMethod, String requestUri) {
+      return false;
+    }
+} activityRequestHandler;
+
+// sleep until the next device update is due, or at most IDLE_MAX_SLEEP so the network is still serviced
+void idle()
+{
+  loopStats.iterations++;
+
+#if defined(IDLE_SLEEP)
+  unsigned long _now = millis();
+  if(_now - loopStats.lastRequest < IDLE_AWAKE_AFTER_REQUEST)
+    return;   // stay responsive while requests are arriving
+
+  unsigned long sleep = DeviceManager.timeUntilNextUpdate(_now);
+  if(sleep > IDLE_MAX_SLEEP)
+    sleep = IDLE_MAX_SLEEP;
+  if(sleep > 0) {
+    unsigned long started = micros();
+    delay(sleep);
+    loopStats.idleMicros += micros() - started;
+    loopStats.idleIterations++;
+  }
+#endif
+}
+
+int loopStatisticsToJson(JsonObject& target)
+{
+  unsigned long long uptime = (unsigned long long)millis() * 1000;
+  target["iterations"] = loopStats.iterations;
+  target["idleIterations"] = loopStats.idleIterations;
+  target["idleMillis"] = (unsigned long)(loopStats.idleMicros / 1000);
+  target["idleRatio"] = uptime ? (float)loopStats.idleMicros / uptime : 0.0f;
+  target["nextUpdate"] = DeviceManager.timeUntilNextUpdate();
+  return 200;
+}
+
+void histogramToJson(JsonStream& json, const char* name, const LatencyHistogram& h)
+{
+  json.beginObject(name);
+  h.toJson(json);
+  json.endObject();
+}
+
+// loop phase timings and the update time of every device, streamed since a large fleet does not fit the heap
+int systemTimingToJson(RestRequest& request)
+{
+  HttpJsonStream json(request.server);
+  json.beginObject();
+  json.member("units", "micros");
+  histogramToJson(json, "loop", loopTiming.busy);
+  json.beginObject("phases");
+  histogramToJson(json, "http", loopTiming.http);
+  histogramToJson(json, "ntp", loopTiming.ntp);
+  histogramToJson(json, "devices", loopTiming.devices);
+  if(display)
+    histogramToJson(json, "displayFlush", display->flushMicros);
+#if defined(ENABLE_INFLUX)
+  histogramToJson(json, "influx", loopTiming.influx);
+#endif
+  json.endObject();
+
+  json.beginArray("devices");
+  for(short i=0; i<DeviceManager.slots; i++) {
+    const Device* dev = DeviceManager.devices[i];
+    if(dev == NULL)
+      continue;
+    const Device::Statistics& stats = dev->getStatistics();
+    json.beginObject();
+    json.member("id", dev->id);
+    if(dev->alias.length() > 0)
+      json.member("alias", dev->alias);
+    if(dev->getDriverName())
+      json.member("driver", dev->getDriverName());
+    histogramToJson(json, "update", stats.updateMicros);
+    json.beginObject("lateness");
+    json.member("units", "millis");
+    stats.latenessMillis.toJson(json);
+    json.endObject();
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+  json.end();
+  return HTTP_RESPONSE_SENT;
+}
+
+// free heap, fragmentation and its history, with live bytes per subsystem when built with HEAP_TELEMETRY
+int systemHeapToJson(RestRequest& request)
+{
+  HttpJsonStream json(request.server);
+  json.beginObject();
+  HeapTelemetry::toJson(json);
+  json.beginObject("requestArena");
+  json.member("capacity", (unsigned long)RequestScratch.capacity());
+  json.member("highWater", (unsigned long)RequestScratch.highWater());
+  json.member("overflows", RequestScratch.overflows());
+  json.endObject();
+  json.endObject();
+  json.end();
+  return HTTP_RESPONSE_SENT;
+}
+
 class OptionsRequestHandler : public RequestHandler
 {
     virtual bool canHandle(HTTPMethod method, String uri) {
@@ -236,70 +387,6 @@ class OptionsRequestHandler : public RequestHandler
 } optionsRequestHandler;
 
 
-#ifdef ENABLE_INFLUX
-void sendToInflux()
-{
-  if (WiFi.status() != WL_CONNECTED)
-    return;
-  if (data.timestamp < TIMESTAMP_MIN) // some time in 2017, before this code was built
-    return;
-  unsigned long stopwatch = millis();
-  String url = influx_server;
-  url += ":8086/write?precision=s&db=";
-  url += influx_database;
-
-  int fields = 0;
-  String post = influx_measurement;
-  post += ",site=";
-  post += hostname;
-  post += " ";
-
-  if (data.humidityPresent) {
-    post += "humidity=";
-    post += data.humidity;
-    post += ",heatIndex=";
-    post += data.heatIndex;
-    fields += 2;
-  }
-  if (data.moisturePresent) {
-    if (fields > 0)
-      post += ",";
-    post += "moisture=";
-    post += data.moisture;
-  }
-  for (int i = 0; i < data.temperatureCount; i++) {
-    if (fields > 0)
-      post += ",";
-    post += "t";
-    post += i;
-    post += "=";
-    post += data.temperature[i];
-  }
-
-  // timestamp
-  post += " ";
-  post += data.timestamp;
-
-  if (true) {
-    HTTPClient http;
-    http.begin(url);
-    http.addHeader("Content-Type", "text/plain");
-    int httpCode = http.POST(post);
-    //String payload = http.getString();
-    //Serial.print("influx: ");
-    //Serial.println(payload);
-    http.end();
-
-    stopwatch = millis() - stopwatch;
-    Serial.print("influx post in ");
-    Serial.print(stopwatch);
-    Serial.print(" millis");
-  }
-  //Serial.print(url);
-  Serial.print(" => ");
-  Serial.println(post);
-}
-#endif
 
 
 void setup() {
@@ -312,6 +399,7 @@ void setup() {
 
   SPIFFS.begin();                           // Start the SPI Flash Files System
  
+  server.addHandler(&activityRequestHandler);
   server.addHandler(&optionsRequestHandler);
   server.on("/", handleRoot);
   //server.on("/status", JsonSendStatus);
@@ -421,6 +509,7 @@ void setup() {
   DeviceManager.add( *(display = new Display()) );             // OLED on I2C bus
   DeviceManager.add( *new DHTSensor(4, 14, DHT22) );      // D5
   DeviceManager.add( *new MotionIR(6, 12) );       // D6
+  //DeviceManager.add( *new FlowMeter(9, 13, 450) );   // hall effect flow sensor on D7, 450 pulses per litre
 
   // we can optionally add the I2C bus as a device which enables external control
   // but without this i2c devices will default to using the system i2c bus
@@ -431,8 +520,29 @@ void setup() {
   
   display->setFontTable(display_fonts);
 
+  DeviceManager.on("/api/system/loop")
+    .GET([](RestRequest& request) { return loopStatisticsToJson(request.response); });
+  DeviceManager.on("/api/system/timing")
+    .GET(systemTimingToJson);
+  DeviceManager.on("/api/system/heap")
+    .GET(systemHeapToJson);
+
+#if defined(IDLE_LIGHT_SLEEP)
+  WiFi.setSleepMode(WIFI_LIGHT_SLEEP);
+#endif
+
+#if defined(NIMBLE_HOST)
+  // host build: put probes on the simulated OneWire bus and add the synthetic fleet requested with --fleet
+  NimbleHost::setOneWireProbes(2, 4);
+  NimbleHost::addSimulatedFleet(DeviceManager);
+#endif
+
   DeviceManager.restoreAliasesFile();
 
+#if defined(ENABLE_INFLUX)
+  influx.begin(influx_server, influx_database, influx_measurement, hostname);
+#endif
+
   Serial.print("Host: ");
   Serial.print(hostname);
   Serial.print("   IP: ");
@@ -440,32 +550,52 @@ void setup() {
 }
 
 
-unsigned long nextInfluxWrite = 0;
-
 void loop() {
 
 #if defined(ALLOW_OTA_UPDATE)
   ArduinoOTA.handle();
 #endif
   
+  unsigned long started = micros(), t = started, phase;
+  {
+    HEAP_SCOPE(HeapWeb);
 #if defined(CAPTIVE_PORTAL)
-  Portal.handleClient();
+    Portal.handleClient();
 #else
-  server.handleClient();
+    server.handleClient();
 #endif
+  }
+  // any response has been sent, memory of the request is no longer referenced
+  RequestScratch.reset();
+  loopTiming.http.add((phase = micros()) - t);
+  t = phase;
 
   // no further processing if we are not in station mode
   if(WiFi.getMode() != WIFI_STA)
     return;
 
   ntp.update();
+  loopTiming.ntp.add((phase = micros()) - t);
+  t = phase;
 
-  DeviceManager.handleUpdate();
+  {
+    HEAP_SCOPE(HeapDevices);
+    DeviceManager.handleUpdate();
+  }
+  loopTiming.devices.add((phase = micros()) - t);
+  t = phase;
 
-#ifdef ENABLE_INFLUX
-  if (enable_influx && influx_server != NULL && millis() > nextInfluxWrite) {
-    nextInfluxWrite = millis() + 60000;
-    sendToInflux();
+#if defined(ENABLE_INFLUX)
+  {
+    HEAP_SCOPE(HeapInflux);
+    influx.handle();
   }
+  loopTiming.influx.add((phase = micros()) - t);
+  t = phase;
 #endif
+
+  HeapTelemetry::handle();
+
+  loopTiming.busy.add(t - started);
+  idle();
 }
@@ -1,19 +1,39 @@
 #include "OneWireSensors.h"
+#include "RequestArena.h"
 
+#include <FS.h>
 
-OneWireSensor::OneWireSensor(short id, int _pin=0)
-  : Device(id, 0, 1000), pin(_pin), oneWire(_pin), DS18B20(&oneWire)
+
+OneWireSensor::OneWireSensor(short id, int _pin, uint8_t _resolution)
+  : Device(id, 0, 1000), pin(_pin), oneWire(_pin), DS18B20(&oneWire), resolution(_resolution), converting(false), conversionStarted(0),
+    probes(NULL), rescanNeeded(true)
 {
   pinMode(pin, INPUT);
 
   // setup OneWire bus
   DS18B20.begin();
-  //DS18B20.setResolution(sensorDeviceAddress, SENSOR_RESOLUTION);
+  DS18B20.setResolution(resolution);
+
+  // we schedule our own read when the conversion is done
+  DS18B20.setWaitForConversion(false);
 }
 
 OneWireSensor::OneWireSensor(const OneWireSensor& copy)
-  : Device(copy), pin(copy.pin), oneWire(copy.oneWire), DS18B20(&oneWire)
+  : Device(copy), pin(copy.pin), oneWire(copy.oneWire), DS18B20(&oneWire), resolution(copy.resolution), converting(false), conversionStarted(0),
+    probes(NULL), rescanNeeded(copy.rescanNeeded)
+{
+  DS18B20.setWaitForConversion(false);
+  if(copy.probes && slots>0) {
+    probes = (DeviceAddress*)calloc(slots, sizeof(DeviceAddress));
+    if(probes)
+      memcpy(probes, copy.probes, slots*sizeof(DeviceAddress));
+  }
+}
+
+OneWireSensor::~OneWireSensor()
 {
+  if(probes)
+    free(probes);
 }
 
 OneWireSensor& OneWireSensor::operator=(const OneWireSensor& copy)
@@ -22,9 +42,27 @@ OneWireSensor& OneWireSensor::operator=(const OneWireSensor& copy)
   pin = copy.pin;
   oneWire = copy.oneWire;
   DS18B20 = copy.DS18B20;
+  resolution = copy.resolution;
+  converting = false;
+  rescanNeeded = copy.rescanNeeded;
+  if(probes) {
+    free(probes);
+    probes = NULL;
+  }
+  if(copy.probes && slots>0) {
+    probes = (DeviceAddress*)calloc(slots, sizeof(DeviceAddress));
+    if(probes)
+      memcpy(probes, copy.probes, slots*sizeof(DeviceAddress));
+  }
   return *this;
 }
 
+void OneWireSensor::setResolution(uint8_t _resolution)
+{
+  resolution = _resolution;
+  DS18B20.setResolution(resolution);
+}
+
 const char* OneWireSensor::getDriverName() const
 {
   return "DallasOneWire";
@@ -36,19 +74,25 @@ int OneWireSensor::httpDevices(RestRequest& request)
   return 200;
 }
 
+int OneWireSensor::httpRescan(RestRequest& request)
+{
+  request.response["found"] = rescan();
+  getDeviceInfo(request.response);
+  return 200;
+}
+
 void OneWireSensor::begin()
 {
+  // restore the slot each probe was pinned to before the reboot
+  loadProbes();
+
   #if 1
   std::function<int(RestRequest&)> func = [](RestRequest& request) {
-    String s("Hello ");
     auto msg = request["msg"];
-    if(msg.isString())
-      s += msg.toString();
-    else {
-      s += '#';
-      s += (long)msg;
-    }
-    request.response["reply"] = s;
+    const char* reply = msg.isString()
+        ? RequestScratch.format("Hello %s", (const char*)msg)
+        : RequestScratch.format("Hello #%ld", (long)msg);
+    request.response["reply"] = reply;
     return 200;
   };
 
@@ -57,6 +101,9 @@ void OneWireSensor::begin()
     .with(*this)
     .on("sensors")
       .GET(&OneWireSensor::httpDevices);
+  on("/onewire/rescan")
+    .with(*this)
+    .POST(&OneWireSensor::httpRescan);
   
   //FakeHandler h = GET(std::bind(&handler_class::m, &c, std::placeholders::_1));
   //Devices::HandlerType h = GET(std::bind(&OneWireSensor::httpDewices, this, std::placeholders::_1));
@@ -67,50 +114,248 @@ void OneWireSensor::begin()
 
 const char* hex = "0123456789ABCDEF";
 
-void OneWireSensor::getDeviceInfo(JsonObject& node)
+// format a ROM address as 28:FF:64:1E:0F:00:00:8C, buffer must hold at least 24 characters
+static char* formatAddress(char* out, const DeviceAddress addr)
 {
-  JsonArray jdevices = node.createNestedArray("devices");
-  
-  uint8_t count = DS18B20.getDS18Count();
-  DeviceAddress devaddr;
-  for (int i = 0; i < count; i++) {
-    if (DS18B20.getAddress(devaddr, i)) {
-      char addr[32];
-      char *paddr = addr;
-      for (int j = 0; j < 8; j++) {
-        if (j > 0)
-          *paddr++ = ':';
-        *paddr++ = hex[ devaddr[j] / 16 ];
-        *paddr++ = hex[ devaddr[j] % 16 ];
+  char *paddr = out;
+  for (int j = 0; j < 8; j++) {
+    if (j > 0)
+      *paddr++ = ':';
+    *paddr++ = hex[ addr[j] / 16 ];
+    *paddr++ = hex[ addr[j] % 16 ];
+  }
+  *paddr=0;
+  return out;
+}
+
+// parse a ROM address in the form written by formatAddress, returns the character after the address or NULL
+static const char* parseAddress(const char* p, DeviceAddress addr)
+{
+  for (int j = 0; j < 8; j++) {
+    if (j > 0 && *p++ != ':')
+      return NULL;
+    if (!isxdigit(p[0]) || !isxdigit(p[1]))
+      return NULL;
+    char hexbyte[3] = { p[0], p[1], 0 };
+    addr[j] = (uint8_t)strtoul(hexbyte, NULL, 16);
+    p += 2;
+  }
+  return p;
+}
+
+static bool isFreeAddress(const DeviceAddress addr)
+{
+  for (int j = 0; j < 8; j++)
+    if (addr[j])
+      return false;
+  return true;
+}
+
+short OneWireSensor::findProbe(const DeviceAddress addr) const
+{
+  if(probes == NULL)
+    return -1;
+  for(short i=0; i<slots; i++)
+    if(memcmp(probes[i], addr, sizeof(DeviceAddress))==0)
+      return i;
+  return -1;
+}
+
+bool OneWireSensor::growProbes(short n)
+{
+  short have = probes ? slots : 0;
+  if(n <= have)
+    return true;
+  DeviceAddress* table = (DeviceAddress*)realloc(probes, n*sizeof(DeviceAddress));
+  if(table == NULL)
+    return false;
+  memset(table + have, 0, (n-have)*sizeof(DeviceAddress));
+  probes = table;
+  return true;
+}
+
+short OneWireSensor::pinProbe(const DeviceAddress addr)
+{
+  if(!growProbes(slots))
+    return -1;
+
+  // take the first free slot, or add a slot
+  short slot = 0;
+  while(slot < slots && !isFreeAddress(probes[slot]))
+    slot++;
+
+  if(slot >= slots) {
+    if(slot+1 >= MAX_SLOTS || !growProbes(slot+1))
+      return -1;
+    alloc(slot+1);
+    if(slot >= slots)
+      return -1;    // no memory for the reading, the larger table is harmless
+  }
+  memcpy(probes[slot], addr, sizeof(DeviceAddress));
+  (*this)[slot] = InvalidReading;
+  return slot;
+}
+
+int OneWireSensor::rescan()
+{
+  int found = 0;
+  short slotsBefore = slots;
+  bool changed = false;
+  DeviceAddress addr;
+
+  // a single walk of the ROM search visits every probe once
+  DS18B20.begin();
+  oneWire.reset_search();
+  while(oneWire.search(addr)) {
+    if(!DS18B20.validAddress(addr) || !DS18B20.validFamily(addr))
+      continue;
+    found++;
+    if(findProbe(addr) < 0 && pinProbe(addr) >= 0)
+      changed = true;
+  }
+  rescanNeeded = false;
+
+  if(changed) {
+    // a new probe starts at its power-on resolution, the conversion time assumes the bus resolution
+    DS18B20.setResolution(resolution);
+    saveProbes();
+  }
+
+  // new slots may have aliases waiting in the aliases file
+  if(slots > slotsBefore && owner)
+    owner->restoreAliasesFile();
+  return found;
+}
+
+void OneWireSensor::reset()
+{
+  if(probes) {
+    free(probes);
+    probes = NULL;
+  }
+  alloc(0);
+  SPIFFS.remove(probesFilename());
+  rescan();
+}
+
+String OneWireSensor::probesFilename() const
+{
+  String fname("/onewire/");
+  fname += id;
+  return fname;
+}
+
+bool OneWireSensor::loadProbes()
+{
+  File f = SPIFFS.open(probesFilename(), "r");
+  if(!f)
+    return false;
+  String contents = f.readString();
+  f.close();
+
+  // one slot=address pair per line
+  const char* p = contents.c_str();
+  while(*p) {
+    DeviceAddress addr;
+    const char* next;
+    if(isdigit(*p)) {
+      short slot = (short)atoi(p);
+      while(isdigit(*p))
+        p++;
+      if(*p++ == '=' && (next = parseAddress(p, addr)) != NULL && slot < MAX_SLOTS-1) {
+        if(slot >= slots) {
+          if(!growProbes(slot+1))
+            return false;   // out of memory, keep the probes loaded so far
+          alloc(slot+1);
+          if(slot >= slots)
+            return false;
+        } else if(!growProbes(slots))
+          return false;
+        memcpy(probes[slot], addr, sizeof(DeviceAddress));
+        p = next;
       }
-      *paddr=0;
+    }
+
+    // skip to next line
+    while(*p && *p++ != '\n')
+      ;
+  }
+  return true;
+}
 
-      jdevices.add(addr);
+bool OneWireSensor::saveProbes() const
+{
+  File f = SPIFFS.open(probesFilename(), "w");
+  if(!f)
+    return false;
+  char addr[32];
+  for(short i=0; i<slots; i++) {
+    if(probes && !isFreeAddress(probes[i])) {
+      f.print(i);
+      f.print('=');
+      f.println(formatAddress(addr, probes[i]));
     }
   }
+  f.close();
+  return true;
+}
+
+void OneWireSensor::getDeviceInfo(JsonObject& node)
+{
+  node["resolution"] = resolution;
+  JsonArray jdevices = node.createNestedArray("devices");
+
+  // probe addresses in slot order
+  char addr[32];
+  for (short i = 0; i < slots; i++) {
+    if (probes && !isFreeAddress(probes[i]))
+      jdevices.add(formatAddress(addr, probes[i]));
+    else
+      jdevices.add((const char*)NULL);
+  }
 }
 
 void OneWireSensor::handleUpdate()
 {
-  bool updateAliases = false;
-  int good = 0, bad = 0;
-  int count = DS18B20.getDS18Count();
+  if(converting)
+    readProbes();
+  else
+    startConversion();
+}
 
-  if(count <=0) {
+void OneWireSensor::startConversion()
+{
+  if(rescanNeeded)
+    rescan();
+
+  if(slots <=0) {
     state = Offline;
     return;
   }
 
-  // ensure we have enough slots
-  if(count > slotCount()) {
-    alloc(count);
-    updateAliases = true;
+  // start the conversion on all probes, then come back to read them once it is done
+  DS18B20.requestTemperatures();
+  conversionStarted = millis();
+  converting = true;
+  delay(DS18B20.millisToWaitForConversion(resolution));
+}
+
+void OneWireSensor::readProbes()
+{
+  int good = 0, bad = 0;
+
+  if(!DS18B20.isConversionComplete()) {
+    // probes are still busy, check again shortly
+    delay(10);
+    return;
   }
+  converting = false;
 
-  // read temperature sensors
-  DS18B20.requestTemperatures();
-  for (int i = 0; i < count; i++) {
-    float f = DS18B20.getTempFByIndex(i);
+  // read each probe by its pinned address
+  for (short i = 0; i < slots; i++) {
+    if(probes == NULL || isFreeAddress(probes[i]))
+      continue;
+    float f = DS18B20.getTempF(probes[i]);
     if (f > DEVICE_DISCONNECTED_F) {
       (*this)[i] = SensorReading(Temperature, f);
       good++;
@@ -119,6 +364,10 @@ void OneWireSensor::handleUpdate()
       bad++;
     }
   }
+
+  // a probe failed to respond, it may have been replaced so search the bus before the next conversion
+  if(bad > 0)
+    rescanNeeded = true;
   
   state = (bad>0)
     ? (good>0)
@@ -126,6 +375,7 @@ void OneWireSensor::handleUpdate()
       : Offline
     : Nominal;
 
-    if(updateAliases)
-      owner->restoreAliasesFile();
+  // keep the update interval measured from the start of the conversion
+  unsigned long elapsed = millis() - conversionStarted;
+  delay((elapsed < updateInterval) ? updateInterval - elapsed : 0);
 }
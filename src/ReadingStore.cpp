@@ -0,0 +1,178 @@
+#include "ReadingStore.h"
+#include "Device.h"
+
+#include <algorithm>
+
+
+static_assert(LastSensorType < 256, "sensor types are stored in a byte");
+
+// resize a column, the column is left as it was if there is not enough memory
+template<class T> static bool resize(T*& column, unsigned int n)
+{
+  T* c = (T*)realloc(column, n * sizeof(T));
+  if(c == NULL)
+    return false;
+  column = c;
+  return true;
+}
+
+ReadingStore::ReadingStore()
+  : sensorTypes(NULL), valueTypes(NULL), timestamps(NULL), values(NULL), nrows(0),
+    indexedTypes(NULL), typeRows(NULL), indexStale(true), base(NULL), nbase(0)
+{
+  memset(typeStart, 0, sizeof(typeStart));
+}
+
+ReadingStore::~ReadingStore()
+{
+  release();
+}
+
+void ReadingStore::release()
+{
+  releaseColumns();
+  if(base) free(base);
+  base = NULL;
+  nbase = 0;
+}
+
+void ReadingStore::releaseColumns()
+{
+  if(sensorTypes) free(sensorTypes);
+  if(valueTypes) free(valueTypes);
+  if(timestamps) free(timestamps);
+  if(values) free(values);
+  if(indexedTypes) free(indexedTypes);
+  if(typeRows) free(typeRows);
+  sensorTypes = NULL;
+  valueTypes = NULL;
+  timestamps = NULL;
+  values = NULL;
+  indexedTypes = NULL;
+  typeRows = NULL;
+  nrows = 0;
+  memset(typeStart, 0, sizeof(typeStart));
+}
+
+void ReadingStore::layout(Device** devices, short ndevices)
+{
+  // the first row of each device, NULL devices get no rows
+  if(nbase != ndevices + 1) {
+    unsigned int* b = (unsigned int*)realloc(base, (ndevices + 1) * sizeof(unsigned int));
+    if(b == NULL) {
+      release();
+      return;
+    }
+    base = b;
+    nbase = ndevices + 1;
+  }
+  unsigned int n = 0;
+  for(short i=0; i<ndevices; i++) {
+    base[i] = n;
+    if(devices[i])
+      n += devices[i]->slotCount();
+  }
+  base[ndevices] = n;
+
+  if(n == 0) {
+    // realloc to 0 would free the columns and return NULL
+    releaseColumns();
+  } else if(n != nrows) {
+    if(!resize(sensorTypes, n) || !resize(valueTypes, n) || !resize(timestamps, n) || !resize(values, n) ||
+        !resize(indexedTypes, n) || !resize(typeRows, n)) {
+      release();
+      return;
+    }
+    nrows = n;
+  }
+  if(n > 0)
+    memset(indexedTypes, Invalid, n);
+  indexStale = true;
+
+  for(short i=0; i<ndevices; i++)
+    if(devices[i])
+      publish(i, *devices[i]);
+}
+
+bool ReadingStore::publish(short ordinal, const Device& device)
+{
+  if(ordinal < 0 || ordinal + 1 >= nbase)
+    return false;
+  unsigned int row = base[ordinal];
+  short n = device.slotCount();
+  if(base[ordinal + 1] - row != (unsigned int)n)
+    return false;
+
+  for(short i=0; i<n; i++, row++) {
+    const SensorReading& r = device[i];
+    if(r.sensorType != Invalid && r.sensorType != indexedTypes[row] && r.sensorType <= LastSensorType)
+      indexStale = true;    // not listed under its type yet
+    sensorTypes[row] = (uint8_t)r.sensorType;
+    valueTypes[row] = r.valueType;
+    timestamps[row] = r.timestamp;
+    values[row] = r.l;
+  }
+  return true;
+}
+
+void ReadingStore::buildIndex()
+{
+  // counting sort of the rows by type, rows of a type stay in row order
+  memset(typeStart, 0, sizeof(typeStart));
+  for(unsigned int row=0; row<nrows; row++) {
+    uint8_t t = sensorTypes[row];
+    if(t != Invalid && t <= LastSensorType)
+      typeStart[t + 1]++;
+  }
+  for(short t=1; t<LastSensorType + 2; t++)
+    typeStart[t] += typeStart[t - 1];
+
+  unsigned int pos[LastSensorType + 1];
+  memcpy(pos, typeStart, sizeof(pos));
+  for(unsigned int row=0; row<nrows; row++) {
+    uint8_t t = sensorTypes[row];
+    if(t != Invalid && t <= LastSensorType) {
+      typeRows[pos[t]++] = row;
+      indexedTypes[row] = t;
+    } else
+      indexedTypes[row] = Invalid;
+  }
+  indexStale = false;
+}
+
+unsigned int ReadingStore::scanType(unsigned int row, unsigned int end, SensorType st, char vt, unsigned long tsFrom, unsigned int& cursor)
+{
+  if(st > LastSensorType)
+    return end;
+  if(indexStale)
+    buildIndex();
+  const unsigned int* list = typeRows + typeStart[st];
+  unsigned int n = typeStart[st + 1] - typeStart[st];
+
+  if(n > nrows / 8) {
+    // a common type is found faster by searching the packed type column than by walking its list
+    while(row < end) {
+      const uint8_t* p = (const uint8_t*)memchr(sensorTypes + row, (uint8_t)st, end - row);
+      if(p == NULL)
+        return end;
+      row = p - sensorTypes;
+      if(accepts(row, vt, tsFrom))
+        return row;
+      row++;
+    }
+    return end;
+  }
+
+  // usually the cursor is at the row returned last, if it does not lead to row look the row up
+  if(cursor < n && list[cursor] < row)
+    cursor++;
+  if(cursor > n || (cursor < n && list[cursor] < row) || (cursor > 0 && list[cursor - 1] >= row))
+    cursor = std::lower_bound(list, list + n, row) - list;
+
+  for(; cursor < n && list[cursor] < end; cursor++) {
+    unsigned int r = list[cursor];
+    if(sensorTypes[r] == st && accepts(r, vt, tsFrom))
+      return r;
+  }
+  return end;
+}
@@ -0,0 +1,166 @@
+#include "RequestArena.h"
+
+#include <stdarg.h>
+
+
+// every allocation is preceded by its size and aligned to this
+#define ARENA_ALIGN   8
+#define ARENA_ROUND(n)  (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define OVERFLOW_HEADER ARENA_ROUND(sizeof(Overflow))
+
+RequestArena RequestScratch;
+
+RequestArena::RequestArena(size_t capacity)
+  : block(NULL), size(ARENA_ROUND(capacity)), top(0), last(0), spilled(0), peak(0), misses(0), overflow(NULL)
+{
+}
+
+RequestArena::~RequestArena()
+{
+  reset();
+  if(block)
+    free(block);
+}
+
+void* RequestArena::allocate(size_t n)
+{
+  if(block == NULL && size > 0) {
+    // taken once and kept, later requests reuse it
+    block = (uint8_t*)malloc(size);
+    if(block == NULL)
+      size = 0;
+  }
+
+  size_t need = ARENA_ALIGN + ARENA_ROUND(n);
+  if(top + need <= size) {
+    *(size_t*)(block + top) = n;
+    last = top;
+    top += need;
+    if(top + spilled > peak)
+      peak = top + spilled;
+    return block + last + ARENA_ALIGN;
+  }
+
+  // does not fit, borrow from the heap until the next reset
+  Overflow* o = (Overflow*)malloc(OVERFLOW_HEADER + n);
+  if(o == NULL)
+    return NULL;
+  o->next = overflow;
+  o->size = n;
+  overflow = o;
+  misses++;
+  spilled += n;
+  if(top + spilled > peak)
+    peak = top + spilled;
+  return (uint8_t*)o + OVERFLOW_HEADER;
+}
+
+size_t RequestArena::sizeOf(const void* ptr) const
+{
+  const uint8_t* p = (const uint8_t*)ptr;
+  if(block && p > block && p < block + size)
+    return *(const size_t*)(p - ARENA_ALIGN);
+  return ((const Overflow*)(p - OVERFLOW_HEADER))->size;
+}
+
+void* RequestArena::reallocate(void* ptr, size_t n)
+{
+  if(ptr == NULL)
+    return allocate(n);
+
+  if(block && ptr == block + last + ARENA_ALIGN && last + ARENA_ALIGN + ARENA_ROUND(n) <= size) {
+    // the last allocation grows or shrinks in place
+    *(size_t*)(block + last) = n;
+    top = last + ARENA_ALIGN + ARENA_ROUND(n);
+    if(top + spilled > peak)
+      peak = top + spilled;
+    return ptr;
+  }
+
+  if(overflow && ptr == (uint8_t*)overflow + OVERFLOW_HEADER) {
+    // the newest overflow is resized on the heap
+    Overflow* o = (Overflow*)realloc(overflow, OVERFLOW_HEADER + n);
+    if(o == NULL)
+      return NULL;
+    spilled = spilled - o->size + n;
+    o->size = n;
+    overflow = o;
+    if(top + spilled > peak)
+      peak = top + spilled;
+    return (uint8_t*)o + OVERFLOW_HEADER;
+  }
+
+  // the old allocation is released with everything else at the next reset
+  size_t old = sizeOf(ptr);
+  void* p = allocate(n);
+  if(p)
+    memcpy(p, ptr, (old < n) ? old : n);
+  return p;
+}
+
+char* RequestArena::strdup(const char* s)
+{
+  size_t n = strlen(s) + 1;
+  char* p = (char*)allocate(n);
+  if(p)
+    memcpy(p, s, n);
+  return p;
+}
+
+char* RequestArena::format(const char* fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(NULL, 0, fmt, args);
+  va_end(args);
+  if(n < 0)
+    return NULL;
+
+  char* p = (char*)allocate(n + 1);
+  if(p) {
+    va_start(args, fmt);
+    vsnprintf(p, n + 1, fmt, args);
+    va_end(args);
+  }
+  return p;
+}
+
+void RequestArena::reset()
+{
+  while(overflow) {
+    Overflow* o = overflow;
+    overflow = o->next;
+    free(o);
+  }
+  top = last = 0;
+  spilled = 0;
+}
+
+
+RequestArena::Text::Text(RequestArena& _arena)
+  : arena(_arena), text(NULL), len(0), room(0)
+{
+}
+
+size_t RequestArena::Text::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t RequestArena::Text::write(const uint8_t *buffer, size_t n)
+{
+  if(len + n + 1 > room) {
+    size_t grow = (room < 64) ? 64 : room * 2;
+    if(grow < len + n + 1)
+      grow = len + n + 1;
+    char* p = (char*)arena.reallocate(text, grow);
+    if(p == NULL)
+      return 0;
+    text = p;
+    room = grow;
+  }
+  memcpy(text + len, buffer, n);
+  len += n;
+  text[len] = 0;
+  return n;
+}
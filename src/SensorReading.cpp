@@ -1,18 +1,102 @@
 
 #include "SensorReading.h"
+#include "JsonStream.h"
 
 
 SensorReading NullReading(Invalid, VT_NULL, 0);
 SensorReading InvalidReading(Invalid, VT_INVALID, 0);
 
 
+// write the digits of an unsigned number backwards ending at end, returns the first digit
+static char* digitsOf(char* end, unsigned long v)
+{
+  do {
+    *--end = (char)('0' + v % 10);
+    v /= 10;
+  } while(v);
+  return end;
+}
+
+// copy text into buf truncating to fit
+static size_t copyTo(char* buf, size_t n, const char* text, size_t len)
+{
+  if(n == 0)
+    return 0;
+  if(len >= n)
+    len = n - 1;
+  memcpy(buf, text, len);
+  buf[len] = 0;
+  return len;
+}
+
+static size_t formatInteger(char* buf, size_t n, long v)
+{
+  char text[sizeof(long) * 3 + 2];
+  char* end = text + sizeof(text);
+  char* p = digitsOf(end, (v < 0) ? -(unsigned long)v : (unsigned long)v);
+  if(v < 0)
+    *--p = '-';
+  return copyTo(buf, n, p, end - p);
+}
+
+size_t formatDecimal(char* buf, size_t n, float value, uint8_t precision)
+{
+  static const unsigned long powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+  if(isnan(value))
+    return copyTo(buf, n, "nan", 3);
+  if(isinf(value))
+    return copyTo(buf, n, "inf", 3);
+  if(value > 4294967040.0f || value < -4294967040.0f)
+    return copyTo(buf, n, "ovf", 3);
+  if(precision > 6)
+    precision = 6;    // beyond the digits a float holds
+
+  // the integer and fraction parts as integers, rounded at the last decimal
+  double v = (value < 0) ? -(double)value : (double)value;
+  unsigned long scale = powers[precision];
+  unsigned long ipart = (unsigned long)v;
+  unsigned long frac = (unsigned long)((v - ipart) * scale + 0.5);
+  if(frac >= scale) {
+    frac -= scale;
+    ipart++;
+  }
+
+  // digits are written backwards from the end of the buffer
+  char text[24];
+  char* end = text + sizeof(text);
+  char* p = end;
+  if(precision > 0) {
+    for(uint8_t i=0; i<precision; i++) {
+      *--p = (char)('0' + frac % 10);
+      frac /= 10;
+    }
+    *--p = '.';
+  }
+  p = digitsOf(p, ipart);
+  if(value < 0)
+    *--p = '-';
+  return copyTo(buf, n, p, end - p);
+}
+
 String SensorAddress::toString() const
 {
-  String s;
-  s += device;
-  s += ':';
-  s += slot;
-  return s;
+  char text[READING_TEXT_SIZE];
+  formatTo(text, sizeof(text));
+  return String(text);
+}
+
+size_t SensorAddress::formatTo(char* buf, size_t n) const
+{
+  char text[16];
+  char* end = text + sizeof(text);
+  char* p = digitsOf(end, (slot < 0) ? -slot : slot);
+  if(slot < 0)
+    *--p = '-';
+  *--p = ':';
+  p = digitsOf(p, (device < 0) ? -device : device);
+  if(device < 0)
+    *--p = '-';
+  return copyTo(buf, n, p, end - p);
 }
 
 
@@ -24,15 +108,27 @@ void SensorReading::clear()
 }
 
 String SensorReading::toString() const {
+    char text[READING_TEXT_SIZE];
+    formatTo(text, sizeof(text));
+    return String(text);
+}
+
+size_t SensorReading::formatTo(char* buf, size_t n, uint8_t precision) const {
     switch(valueType) {
       case 'i':
-      case 'l': return String(l); break;
-      case 'f': return String(f); break;
-      case 'b': return String(b ? "true":"false"); break;
+      case 'l': return formatInteger(buf, n, l);
+      case 'f': return formatDecimal(buf, n, f, precision);
+      case 'b': return b ? copyTo(buf, n, "true", 4) : copyTo(buf, n, "false", 5);
       case 'n':
       default:
-        return "null"; break;
-    }  
+        return copyTo(buf, n, "null", 4);
+    }
+}
+
+size_t SensorReading::printTo(Print& out) const {
+    char text[READING_TEXT_SIZE];
+    size_t len = formatTo(text, sizeof(text));
+    return out.write((const uint8_t*)text, len);
 }
 
 void SensorReading::addTo(JsonArray& arr) const
@@ -63,3 +159,35 @@ void SensorReading::toJson(JsonObject& root, bool showType, bool showTimestamp)
       root["value"] = (char*)NULL; break;
   }
 }
+
+void SensorReading::addTo(JsonStream& json) const
+{
+  switch(valueType) {
+    case 'i':
+    case 'l': json.value(l); break;
+    case 'f': json.value(f); break;
+    case 'b': json.value(b); break;
+    case 'n':
+    default:
+      json.null(); break;
+  }
+}
+
+void SensorReading::toJson(JsonStream& json, bool showType, bool showTimestamp) const
+{
+  if(showType)
+    json.member("type", SensorTypeName(sensorType));
+  if(showTimestamp)
+    json.member("ts", timestamp);
+  switch(valueType) {
+    case 'i':
+    case 'l': json.member("value", l); break;
+    case 'f': if(!isnan(f)) json.member("value", f); break;
+    case 'b': json.member("value", b); break;
+    case 'n':
+    default:
+      json.key("value");
+      json.null();
+      break;
+  }
+}
@@ -0,0 +1,155 @@
+#include "SlotHistory.h"
+
+
+#define HISTORY_GAP       ((int16_t)-32768)   // marks a filler sample that only carries time
+#define HISTORY_MAX_DT    0xffff
+
+// the value of one quantization step for each type of sensor
+static float quantumFor(SensorType st, char vt)
+{
+  if(vt != VT_FLOAT)
+    return 1.0f;    // integers and booleans are stored as-is
+  switch(st) {
+    case pH:
+    case DissolvedOxygen:
+      return 0.001f;
+    case Pressure:
+    case AirPressure:
+    case Altitude:
+      return 0.1f;
+    case Conductivity:
+    case CO2:
+    case Illuminance:
+      return 1.0f;
+    default:
+      return 0.01f;
+  }
+}
+
+size_t SlotHistory::sampleSize()
+{
+  return sizeof(Sample);
+}
+
+SlotHistory::SlotHistory()
+  : samples(NULL), size(0), head(0), n(0), first(0), tail(0), latest(0), sensorType(Invalid), valueType(VT_CLEAR), offset(0), quantum(1)
+{
+}
+
+SlotHistory::~SlotHistory()
+{
+  if(samples)
+    free(samples);
+}
+
+bool SlotHistory::alloc(unsigned short _capacity)
+{
+  if(samples)
+    free(samples);
+  samples = (_capacity > 0)
+    ? (Sample*)calloc(_capacity, sizeof(Sample))
+    : NULL;
+  size = samples ? _capacity : 0;
+  clear();
+  return samples != NULL;
+}
+
+void SlotHistory::clear()
+{
+  head = n = 0;
+  first = tail = latest = 0;
+}
+
+void SlotHistory::dropOldest()
+{
+  head = (head + 1) % size;
+  n--;
+  if(n > 0)
+    first += (unsigned long)samples[head].dt << HISTORY_TIME_SHIFT;   // the next sample is now the oldest
+}
+
+void SlotHistory::push(uint16_t dt, int16_t value)
+{
+  if(n == size)
+    dropOldest();
+  Sample& s = samples[(head + n) % size];
+  s.dt = dt;
+  s.value = value;
+  n++;
+}
+
+void SlotHistory::add(const SensorReading& r)
+{
+  if(size == 0 || !r || r.valueType == VT_CLEAR || r.valueType == VT_NULL)
+    return;   // nothing measured
+
+  if(n == 0 || r.sensorType != sensorType || r.valueType != valueType) {
+    // first sample (or the slot changed type), the value becomes the reference for quantizing
+    clear();
+    sensorType = r.sensorType;
+    valueType = r.valueType;
+    quantum = quantumFor(sensorType, valueType);
+    offset = (valueType == VT_FLOAT) ? r.f : (valueType == VT_BOOL) ? 0 : (float)r.l;
+    first = tail = latest = r.timestamp;
+    push(0, 0);
+    return;
+  }
+
+  if(r.timestamp <= latest)
+    return;   // not newer than what we have
+
+  // long gaps are bridged with time-only filler samples, if there are too many just start over
+  unsigned long dt = (r.timestamp - tail) >> HISTORY_TIME_SHIFT;
+  if(dt / HISTORY_MAX_DT >= size) {
+    clear();
+    add(r);
+    return;
+  }
+  while(dt > HISTORY_MAX_DT) {
+    push(HISTORY_MAX_DT, HISTORY_GAP);
+    tail += (unsigned long)HISTORY_MAX_DT << HISTORY_TIME_SHIFT;
+    dt -= HISTORY_MAX_DT;
+  }
+
+  // quantize the value, clamping to the range of a sample
+  float v = (valueType == VT_FLOAT) ? r.f : (valueType == VT_BOOL) ? (r.b ? 1 : 0) : (float)r.l;
+  float q = (v - offset) / quantum;
+  long qv = (q >= 0) ? (long)(q + 0.5f) : (long)(q - 0.5f);
+  if(qv > 32767) qv = 32767;
+  if(qv < -32767) qv = -32767;
+
+  // the delta is measured from the decoded time of the previous sample so rounding does not accumulate
+  push((uint16_t)dt, (int16_t)qv);
+  tail += dt << HISTORY_TIME_SHIFT;
+  latest = r.timestamp;
+  if(n == 1)
+    first = tail;   // everything older was dropped
+}
+
+bool SlotHistory::next(unsigned short& pos, unsigned long& ts, SensorReading& r) const
+{
+  while(pos < n) {
+    const Sample& s = samples[(head + pos) % size];
+    ts = (pos == 0)
+      ? first
+      : ts + ((unsigned long)s.dt << HISTORY_TIME_SHIFT);
+    pos++;
+
+    if(s.value == HISTORY_GAP)
+      continue;
+
+    // the newest sample has the exact timestamp
+    r.timestamp = (pos == n) ? latest : ts;
+    r.sensorType = sensorType;
+    r.valueType = valueType;
+    float v = offset + s.value * quantum;
+    if(valueType == VT_FLOAT)
+      r.f = v;
+    else if(valueType == VT_BOOL)
+      r.b = s.value != 0;
+    else
+      r.l = (long)offset + s.value;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,97 @@
+#include "TrendSeries.h"
+
+
+// the time covered by each bucket
+static unsigned long bucketPeriod(unsigned long period, unsigned short size)
+{
+  unsigned long ms = (size > 0) ? period / size : 1;
+  return (ms > 0) ? ms : 1;
+}
+
+TrendSeries::TrendSeries(short _deviceId, short _slot, unsigned short _size, unsigned long period)
+  : deviceId(_deviceId), slot(_slot), buckets(NULL), nbuckets(_size), bucketMs(1), head(0), lastTimestamp(0)
+{
+  bucketMs = bucketPeriod(period, nbuckets);
+  if(nbuckets > 0)
+    buckets = (Bucket*)calloc(nbuckets, sizeof(Bucket));
+  if(buckets == NULL)
+    nbuckets = 0;
+  head = millis() / bucketMs;
+}
+
+bool TrendSeries::matches(short _deviceId, short _slot, unsigned short _size, unsigned long period) const
+{
+  return deviceId == _deviceId && slot == _slot && nbuckets == _size && bucketMs == bucketPeriod(period, _size);
+}
+
+TrendSeries::~TrendSeries()
+{
+  if(buckets)
+    free(buckets);
+}
+
+bool TrendSeries::advance(unsigned long now)
+{
+  unsigned long n = now / bucketMs;
+  if(n <= head || nbuckets == 0)
+    return false;
+
+  // empty the buckets that scroll in, after a long gap that is all of them
+  unsigned long clear = n - head;
+  if(clear > nbuckets)
+    clear = nbuckets;
+  for(unsigned long b = n - clear + 1; b <= n; b++)
+    buckets[b % nbuckets].count = 0;
+  head = n;
+  return true;
+}
+
+bool TrendSeries::add(const SensorReading& r)
+{
+  if(nbuckets == 0 || r.timestamp == lastTimestamp)
+    return false;
+
+  float v;
+  switch(r.valueType) {
+    case VT_FLOAT: v = r.f; break;
+    case VT_LONG: v = (float)r.l; break;
+    case VT_BOOL: v = r.b ? 1 : 0; break;
+    default: return false;   // no value
+  }
+  if(isnan(v))
+    return false;
+
+  advance(r.timestamp);
+  unsigned long n = r.timestamp / bucketMs;
+  if(n + nbuckets <= head)
+    return false;   // older than the window
+  lastTimestamp = r.timestamp;
+
+  Bucket& b = buckets[n % nbuckets];
+  if(b.count == 0) {
+    b.min = b.max = b.sum = v;
+    b.count = 1;
+  } else {
+    if(v < b.min) b.min = v;
+    if(v > b.max) b.max = v;
+    b.sum += v;
+    if(b.count < 0xffff)
+      b.count++;
+    else
+      b.sum -= b.sum / b.count;   // keep the average without overflowing the count
+  }
+  return true;
+}
+
+bool TrendSeries::get(unsigned short i, float& min, float& max, float& avg) const
+{
+  if(i >= nbuckets)
+    return false;
+  const Bucket& b = buckets[(head + 1 + i) % nbuckets];
+  if(b.count == 0)
+    return false;
+  min = b.min;
+  max = b.max;
+  avg = b.sum / b.count;
+  return true;
+}
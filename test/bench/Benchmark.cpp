@@ -0,0 +1,128 @@
+#include "Benchmark.h"
+
+#include <NimbleConfig.h>
+
+#include <algorithm>
+#include <chrono>
+
+
+namespace Bench {
+
+  typedef std::chrono::steady_clock Clock;
+
+  Options options;
+
+  // results are accumulated here so the compiler cannot drop the operation being measured
+  static volatile long sink;
+
+  Options::Options()
+    : filter(NULL), minTimeUs(20000), samples(5), quick(false)
+  {
+  }
+
+  std::vector<short> deviceCounts()
+  {
+    std::vector<short> counts;
+    for(int n = 4; n <= MAX_DEVICES && n <= MAX_SLOTS; n *= options.quick ? 8 : 4)
+      counts.push_back((short)n);
+    return counts;
+  }
+
+  std::vector<short> slotCounts()
+  {
+    std::vector<short> counts;
+    for(int n = 4; n <= MAX_SLOTS; n *= options.quick ? 8 : 4)
+      counts.push_back((short)n);
+    return counts;
+  }
+
+  bool selected(const char* suite, const char* name)
+  {
+    return options.filter == NULL || strstr(suite, options.filter) != NULL || strstr(name, options.filter) != NULL;
+  }
+
+  static double sample(std::function<long()>& op, unsigned long iterations)
+  {
+    long acc = 0;
+    Clock::time_point start = Clock::now();
+    for(unsigned long i=0; i<iterations; i++)
+      acc += op();
+    Clock::time_point end = Clock::now();
+    sink = sink + acc;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  }
+
+  void run(const char* suite, const char* name, const Params& params, std::function<long()> op, long itemsPerOp)
+  {
+    if(!selected(suite, name))
+      return;
+
+    // calibrate, double the iterations until one sample takes at least minTimeUs
+    unsigned long iterations = 1;
+    double elapsed;
+    while((elapsed = sample(op, iterations)) < options.minTimeUs * 1000.0 && iterations < (1UL<<30))
+      iterations *= 2;
+
+    std::vector<double> nsPerOp;
+    nsPerOp.push_back(elapsed / iterations);
+    unsigned long allocations = NimbleHost::heapCounters().allocations;
+    for(int s=1; s<options.samples; s++)
+      nsPerOp.push_back(sample(op, iterations) / iterations);
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    // heap allocations per op, measured over the extra samples or one more if there were none
+    int counted = options.samples - 1;
+    if(counted == 0) {
+      sample(op, iterations);
+      counted = 1;
+    }
+    double allocsPerOp = (double)(NimbleHost::heapCounters().allocations - allocations) / ((double)iterations * counted);
+
+    printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"devices\":%d,\"slots\":%d,\"iterations\":%lu,"
+           "\"ns_per_op\":%.1f,\"min_ns\":%.1f,\"max_ns\":%.1f,\"items_per_op\":%ld",
+      suite, name, params.devices, params.slots, iterations,
+      nsPerOp[nsPerOp.size()/2], nsPerOp.front(), nsPerOp.back(), itemsPerOp);
+    if(NimbleHost::heapCountersAvailable())
+      printf(",\"allocs_per_op\":%.2f", allocsPerOp);
+    printf("}\n");
+    fflush(stdout);
+  }
+
+  void report(const char* suite, const char* name, const Params& params, const char* metric, double value)
+  {
+    if(!selected(suite, name))
+      return;
+    printf("{\"suite\":\"%s\",\"bench\":\"%s\",\"devices\":%d,\"slots\":%d,\"%s\":%.1f}\n",
+      suite, name, params.devices, params.slots, metric, value);
+    fflush(stdout);
+  }
+}
+
+
+// the benchmark program has no sketch
+void setup() {}
+void loop() {}
+
+int main(int argc, char** argv)
+{
+  for(int i=1; i<argc; i++) {
+    const char* arg = argv[i];
+    if(strncmp(arg, "--filter=", 9)==0)
+      Bench::options.filter = arg + 9;
+    else if(strncmp(arg, "--min-time-us=", 14)==0)
+      Bench::options.minTimeUs = strtoul(arg + 14, NULL, 10);
+    else if(strncmp(arg, "--samples=", 10)==0)
+      Bench::options.samples = std::max(1, atoi(arg + 10));
+    else if(strcmp(arg, "--quick")==0)
+      Bench::options.quick = true;
+  }
+
+  // drivers print diagnostics, keep stdout for results
+  NimbleHost::setSerialEcho(false);
+  NimbleHost::useVirtualClock(true);
+
+  Bench::devicesSuite();
+  Bench::readingsSuite();
+  Bench::influxSuite();
+  return 0;
+}
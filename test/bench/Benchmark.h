@@ -0,0 +1,68 @@
+/**
+ * @file Benchmark.h
+ * @brief Minimal microbenchmark harness for the host (native) build.
+ * Each measurement is auto-calibrated to run for a minimum time, repeated a few times and reported as one JSON
+ * object per line on stdout so results can be collected and compared by scripts.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#pragma once
+
+#include <NimbleHost.h>
+
+#include <functional>
+#include <vector>
+
+namespace Bench {
+
+  /// @brief Describes the shape of the data a benchmark ran against
+  struct Params {
+    short devices;
+    short slots;
+
+    inline Params(short _devices=0, short _slots=0) : devices(_devices), slots(_slots) {}
+  };
+
+  /// @brief Options parsed from the command line
+  struct Options {
+    const char* filter;         /// only run benchmarks whose suite or name contains this text
+    unsigned long minTimeUs;    /// calibrate each sample to run at least this long
+    int samples;                /// number of samples, the median is reported
+    bool quick;                 /// limit the parameter sweep
+
+    Options();
+  };
+
+  extern Options options;
+
+  /// @brief Values of the parameter sweep, 4 up to MAX_SLOTS (or MAX_DEVICES for device counts)
+  std::vector<short> deviceCounts();
+  std::vector<short> slotCounts();
+
+  /**
+   * @brief Measure a single operation and print the result.
+   *
+   * @param suite Group the benchmark belongs to, for example "devices".
+   * @param name Name of the operation being measured.
+   * @param params Shape of the data the operation ran against.
+   * @param op The operation, called repeatedly. It returns a value that is consumed so it cannot be optimized away.
+   * @param itemsPerOp Optional count of items each op processes, reported so per-item cost can be derived.
+   */
+  void run(const char* suite, const char* name, const Params& params, std::function<long()> op, long itemsPerOp=1);
+
+  /// @brief Print an extra metric that is not a timing, such as a byte count, as a JSON line
+  void report(const char* suite, const char* name, const Params& params, const char* metric, double value);
+
+  /// @brief true if the benchmark is selected by the --filter option
+  bool selected(const char* suite, const char* name);
+
+  /// @name Suites
+  /// @{
+  void devicesSuite();
+  void readingsSuite();
+  void influxSuite();
+  /// @}
+}
@@ -0,0 +1,267 @@
+#include "Benchmark.h"
+
+#include <NimbleAPI.h>
+#include <JsonStream.h>
+#include <SimulatedDevice.h>
+
+#include <ArduinoJson.h>
+
+
+namespace Bench {
+
+  /// @brief A device manager populated with simulated devices, with readings spread over time
+  class Fleet
+  {
+    public:
+      Devices manager;
+      short devices;
+      short slots;
+
+      Fleet(short _devices, short _slots)
+        : manager(_devices), devices(_devices), slots(_slots)
+      {
+        NimbleHost::addSimulatedFleet(manager, devices, slots, 1);
+
+        // take one reading on every device, 10ms apart, so timestamp filters have something to select
+        for(short i=0; i<devices; i++) {
+          Device* dev = manager.devices[i];
+          NimbleHost::advanceClock(10);
+          dev->handleUpdate();
+        }
+      }
+
+      ~Fleet()
+      {
+        for(short i=0; i<devices; i++) {
+          Device* dev = manager.devices[i];
+          if(dev)
+            delete dev;   // removes itself from the manager
+        }
+      }
+
+      /// @brief an alias file naming every device and every slot
+      String aliasesFile() const
+      {
+        String out;
+        for(short i=0; i<devices; i++) {
+          const Device* dev = manager.devices[i];
+          out += dev->id; out += "=dev"; out += dev->id; out += '\n';
+          for(short s=0; s<slots; s++) {
+            out += dev->id; out += ':'; out += s;
+            out += "=dev"; out += dev->id; out += ".s"; out += s; out += '\n';
+          }
+        }
+        return out;
+      }
+
+      inline const Device& last() const { return *manager.devices[devices-1]; }
+      inline unsigned long firstTimestamp() const { return (*manager.devices[0])[0].timestamp; }
+      inline unsigned long lastTimestamp() const { return last()[0].timestamp; }
+  };
+
+  /// @brief Discards output, counting the bytes
+  class NullPrint : public Print
+  {
+    public:
+      size_t bytes;
+      inline NullPrint() : bytes(0) {}
+      virtual size_t write(uint8_t) { bytes++; return 1; }
+      virtual size_t write(const uint8_t*, size_t size) { bytes += size; return size; }
+  };
+
+  static long drain(Devices::ReadingIterator itr)
+  {
+    long n = 0;
+    while(itr.next())
+      n++;
+    return n;
+  }
+
+  static void iteratorBenchmarks(Fleet& fleet, const Params& p)
+  {
+    Devices& dm = fleet.manager;
+    long total = (long)fleet.devices * fleet.slots;
+    unsigned long mid = fleet.firstTimestamp() + (fleet.lastTimestamp() - fleet.firstTimestamp()) / 2;
+    unsigned long quarter = fleet.firstTimestamp() + (fleet.lastTimestamp() - fleet.firstTimestamp()) / 4;
+    short lastId = fleet.last().id;
+
+    run("devices", "ReadingIterator::next", p, [&]() {
+      return drain(dm.forEach());
+    }, total);
+
+    run("devices", "ReadingIterator::next(OfType)", p, [&]() {
+      return drain(dm.forEach(Temperature));
+    }, total);
+
+    run("devices", "ReadingIterator::next(After)", p, [&]() {
+      return drain(dm.forEach().After(mid));
+    }, total);
+
+    run("devices", "ReadingIterator::next(TimeBetween)", p, [&]() {
+      return drain(dm.forEach().TimeBetween(quarter, mid));
+    }, total);
+
+    run("devices", "ReadingIterator::next(OfType,TimeBetween)", p, [&]() {
+      return drain(dm.forEach(Temperature).TimeBetween(quarter, mid));
+    }, total);
+
+    run("devices", "ReadingIterator::next(device)", p, [&]() {
+      return drain(dm.forEach(lastId));
+    }, fleet.slots);
+  }
+
+  static void schedulerBenchmarks()
+  {
+    for(short devices : deviceCounts()) {
+      Params p(devices, 4);
+      Fleet fleet(devices, 4);
+      Devices& dm = fleet.manager;
+      dm.setUpdateBudget(0xffffffff);
+
+      // bring every device up to date so nothing is due
+      NimbleHost::advanceClock(60001);
+      dm.handleUpdate();
+
+      run("devices", "Devices::handleUpdate(idle)", p, [&]() {
+        dm.handleUpdate();
+        return (long)dm.timeUntilNextUpdate();
+      });
+
+      // time moves 1ms per call, so devices come due at their natural rate
+      run("devices", "Devices::handleUpdate(1ms)", p, [&]() {
+        NimbleHost::advanceClock(1);
+        dm.handleUpdate();
+        return (long)dm.timeUntilNextUpdate();
+      });
+
+      // every device is due on every call
+      run("devices", "Devices::handleUpdate(all-due)", p, [&]() {
+        NimbleHost::advanceClock(60001);
+        dm.handleUpdate();
+        return (long)dm.timeUntilNextUpdate();
+      }, devices);
+    }
+  }
+
+  /// @brief Alias lookup through the index compared with a linear scan of the devices and slots
+  static void aliasBenchmarks()
+  {
+    const short devices = 32, slots = MAX_SLOTS;
+    Params p(devices, slots);
+    Fleet fleet(devices, slots);
+    Devices& dm = fleet.manager;
+    String aliases = fleet.aliasesFile();
+    dm.parseAliasesFile(aliases.c_str());
+
+    const Device& last = fleet.last();
+    String lastAlias = last.alias;
+    String lastSlotAlias = last.getSlotAlias(slots-1);
+
+    // an unmanaged device has no index and searches its slots
+    SimulatedDevice unmanaged(999, slots);
+    for(short s=0; s<slots; s++)
+      unmanaged.setSlotAlias(s, last.getSlotAlias(s));
+
+    run("devices", "alias:find(String,indexed)", p, [&]() {
+      return (long)dm.find(lastAlias).id;
+    });
+
+    run("devices", "alias:find(String,linear)", p, [&]() {
+      for(short i=0; i<devices; i++)
+        if(dm.devices[i] && dm.devices[i]->alias == lastAlias)
+          return (long)dm.devices[i]->id;
+      return -1L;
+    });
+
+    run("devices", "alias:findSlotByAlias(indexed)", p, [&]() {
+      return (long)last.findSlotByAlias(lastSlotAlias);
+    });
+
+    run("devices", "alias:findSlotByAlias(linear)", p, [&]() {
+      return (long)unmanaged.findSlotByAlias(lastSlotAlias);
+    });
+  }
+
+  void devicesSuite()
+  {
+    schedulerBenchmarks();
+    aliasBenchmarks();
+
+    for(short devices : deviceCounts()) {
+      for(short slots : slotCounts()) {
+        Params p(devices, slots);
+        Fleet fleet(devices, slots);
+        Devices& dm = fleet.manager;
+
+        String aliases = fleet.aliasesFile();
+        dm.parseAliasesFile(aliases.c_str());
+
+        const Device& last = fleet.last();
+        short lastId = last.id;
+        String lastAlias = last.alias;
+        String missing("no-such-device");
+
+        run("devices", "Devices::find(short)", p, [&]() {
+          return (long)dm.find(lastId).id;
+        });
+
+        run("devices", "Devices::find(String)", p, [&]() {
+          return (long)dm.find(lastAlias).id;
+        });
+
+        run("devices", "Devices::find(String,miss)", p, [&]() {
+          return (long)dm.find(missing).id;
+        });
+
+        String lastSlotAlias = last.getSlotAlias(slots-1);
+        run("devices", "Device::findSlotByAlias", p, [&]() {
+          return (long)last.findSlotByAlias(lastSlotAlias);
+        });
+
+        unsigned short slot = 0;
+        run("devices", "Devices::getReading", p, [&]() {
+          slot = (unsigned short)((slot + 7) % slots);
+          return (long)dm.getReading(lastId, slot).timestamp;
+        });
+
+        iteratorBenchmarks(fleet, p);
+
+        DynamicJsonDocument doc((size_t)devices * slots * 64 + 4096);
+        run("devices", "Devices::jsonGetDevices", p, [&]() {
+          JsonObject root = doc.to<JsonObject>();
+          dm.jsonGetDevices(root);
+          return (long)doc.memoryUsage();
+        }, (long)devices * slots);
+
+        run("devices", "Device::toJson", p, [&]() {
+          JsonObject root = doc.to<JsonObject>();
+          last.toJson(root, (Device::JsonFlags)(Device::JsonSlots|Device::JsonStatistics));
+          return (long)doc.memoryUsage();
+        }, slots);
+
+        NullPrint out;
+        run("devices", "Devices::jsonGetDevices(stream)", p, [&]() {
+          PrintJsonStream json(out);
+          json.beginObject();
+          dm.jsonGetDevices(json);
+          json.endObject();
+          json.flush();
+          return (long)json.bytesWritten();
+        }, (long)devices * slots);
+
+        run("devices", "Device::toJson(stream)", p, [&]() {
+          PrintJsonStream json(out);
+          json.beginObject();
+          last.toJson(json, (Device::JsonFlags)(Device::JsonSlots|Device::JsonStatistics));
+          json.endObject();
+          json.flush();
+          return (long)json.bytesWritten();
+        }, slots);
+
+        run("devices", "Devices::parseAliasesFile", p, [&]() {
+          return (long)dm.parseAliasesFile(aliases.c_str());
+        }, (long)devices * (slots + 1));
+      }
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#include "Benchmark.h"
+
+#include <NimbleAPI.h>
+#include <InfluxExporter.h>
+#include <SimulatedDevice.h>
+
+
+namespace Bench {
+
+  /// @brief Exporting readings as line protocol to a stand-in server that accepts every post
+  void influxSuite()
+  {
+    const short devices = 32, slots = 8;
+    Params p(devices, slots);
+    Devices manager(devices);
+    NimbleHost::addSimulatedFleet(manager, devices, slots, 1);
+
+    size_t bytes = 0;
+    NimbleHost::onHttpClient([&](const char* method, const String& url, const String& body, String& response) {
+      bytes += body.length();
+      return 204;
+    });
+    WiFi.begin("bench");
+
+    WiFiUDP udp;
+    NTPClient ntp(udp);
+    InfluxExporter influx(manager, ntp);
+    // room for the points of one op
+    influx.begin("http://localhost", "nimble", "bench", "host", INFLUX_BATCH_SIZE, 32);
+
+    // every op takes a new reading on every slot then exports them, stepping the uploads until all are posted
+    run("influx", "InfluxExporter::collect+upload", p, [&]() {
+      for(short i=0; i<devices; i++)
+        manager.devices[i]->handleUpdate();
+      NimbleHost::advanceClock(10);
+      long n = influx.collect();
+      influx.flush();
+      while(influx.pending() > 0)
+        influx.handle();
+      return n;
+    }, (long)devices * slots);
+
+    const InfluxExporter::Statistics& stats = influx.getStatistics();
+    if(stats.posts > 0)
+      report("influx", "InfluxExporter::collect+upload", p, "points_per_post", (double)stats.points / stats.posts);
+    if(stats.dropped > 0)
+      report("influx", "InfluxExporter::collect+upload", p, "dropped_points", (double)stats.droppedPoints);
+
+    NimbleHost::onHttpClient(NULL);
+    for(short i=0; i<devices; i++)
+      delete manager.devices[i];
+  }
+}
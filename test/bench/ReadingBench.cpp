@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+
+#include <SensorReading.h>
+
+
+namespace Bench {
+
+  /// @brief Discards output, counting the bytes
+  class CountingPrint : public Print
+  {
+    public:
+      size_t bytes;
+      inline CountingPrint() : bytes(0) {}
+      virtual size_t write(uint8_t) { bytes++; return 1; }
+      virtual size_t write(const uint8_t*, size_t size) { bytes += size; return size; }
+  };
+
+  /// @brief Formatting a reading as text, through a String and through the allocation free paths
+  void readingsSuite()
+  {
+    Params p(1, 1);
+    SensorReading readings[] = {
+      SensorReading(Temperature, 22.5f),
+      SensorReading(Humidity, -0.125f),
+      SensorReading(Pressure, 101325.75f),
+      SensorReading(Motion, true),
+      SensorReading(Numeric, 123456L)
+    };
+    const long count = sizeof(readings) / sizeof(readings[0]);
+    SensorAddress address(12, 3);
+
+    run("readings", "SensorReading::toString", p, [&]() {
+      long len = 0;
+      for(const SensorReading& r : readings)
+        len += r.toString().length();
+      return len;
+    }, count);
+
+    run("readings", "SensorReading::formatTo", p, [&]() {
+      char text[READING_TEXT_SIZE];
+      long len = 0;
+      for(const SensorReading& r : readings)
+        len += r.formatTo(text, sizeof(text));
+      return len;
+    }, count);
+
+    CountingPrint out;
+    run("readings", "SensorReading::printTo", p, [&]() {
+      long len = 0;
+      for(const SensorReading& r : readings)
+        len += r.printTo(out);
+      return len;
+    }, count);
+
+    run("readings", "Print::print(float)", p, [&]() {
+      return (long)out.print(readings[0].f);
+    });
+
+    run("readings", "formatDecimal", p, [&]() {
+      char text[READING_TEXT_SIZE];
+      return (long)formatDecimal(text, sizeof(text), readings[0].f);
+    });
+
+    run("readings", "SensorAddress::toString", p, [&]() {
+      return (long)address.toString().length();
+    });
+
+    run("readings", "SensorAddress::formatTo", p, [&]() {
+      char text[READING_TEXT_SIZE];
+      return (long)address.formatTo(text, sizeof(text));
+    });
+  }
+}
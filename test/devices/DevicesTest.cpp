@@ -0,0 +1,163 @@
+/**
+ * @file DevicesTest.cpp
+ * @brief Checks of the device manager, reading iterators and Json output for the host (native) build.
+ * Run from the project root, the exit code is the number of failed checks:
+ *   pio run -e native-devices && .pio/build/native-devices/program [--filter=slots]
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <NimbleHost.h>
+#include <Device.h>
+#include <Devices.h>
+#include <JsonStream.h>
+
+#include <functional>
+
+
+namespace DevicesTest {
+
+  static const char* filter = NULL;
+  static int failures = 0;
+
+  #define CHECK(cond) check((cond), #cond, __LINE__)
+
+  static const char* current = "";
+
+  static void check(bool passed, const char* what, int line)
+  {
+    if(!passed) {
+      fprintf(stderr, "FAIL %s: %s (line %d)\n", current, what, line);
+      failures++;
+    }
+  }
+
+  static void test(const char* name, std::function<void()> body)
+  {
+    if(filter && strstr(name, filter) == NULL)
+      return;
+    int before = failures;
+    current = name;
+    body();
+    if(failures == before)
+      fprintf(stderr, "ok   %s\n", name);
+  }
+
+  static long count(Devices::ReadingIterator itr)
+  {
+    long n = 0;
+    while(itr.next())
+      n++;
+    return n;
+  }
+
+  /// @brief A device with readings set by the test
+  class FixedDevice : public Device
+  {
+    public:
+      inline FixedDevice(short id, short slots) : Device(id, slots) {}
+      virtual const char* getDriverName() const { return "Fixed"; }
+  };
+
+  void slotCases()
+  {
+    test("slots-unwritten", []() {
+      Devices devices(4);
+      FixedDevice dev(1, 4);
+      devices.add(dev);
+      dev[0] = SensorReading(Temperature, 21.5f);
+
+      // only the slot the driver wrote is a reading
+      CHECK(dev[0]);
+      for(unsigned short i=1; i<dev.slotCount(); i++)
+        CHECK(!((const Device&)dev)[i]);
+      CHECK(count(devices.forEach()) == 1);
+      CHECK(count(devices.forEach((short)1)) == 1);
+      CHECK(count(devices.forEach(Numeric)) == 0);
+    });
+
+    test("slots-grown", []() {
+      Devices devices(4);
+      FixedDevice dev(1, 2);
+      devices.add(dev);
+      dev[0] = SensorReading(Humidity, 40.0f);
+
+      // writing past the end grows the slots, the slots in between hold no reading
+      dev[4] = SensorReading(Humidity, 45.0f);
+      CHECK(dev.slotCount() == 5);
+      for(unsigned short i=1; i<4; i++)
+        CHECK(!((const Device&)dev)[i]);
+      CHECK(count(devices.forEach()) == 2);
+      CHECK(count(devices.forEach(Humidity)) == 2);
+      CHECK(count(devices.forEach(Numeric)) == 0);
+    });
+
+    test("slots-copied", []() {
+      FixedDevice dev(1, 3);
+      dev[1] = SensorReading(Pressure, 1013.0f);
+
+      // a copy keeps the readings and the unwritten slots
+      FixedDevice copy(dev);
+      CHECK(copy.slotCount() == 3);
+      CHECK(!((const Device&)copy)[0]);
+      CHECK(((const Device&)copy)[1].f == 1013.0f);
+      CHECK(!((const Device&)copy)[2]);
+    });
+  }
+
+  /// @brief Collects printed text
+  class TextPrint : public Print
+  {
+    public:
+      String text;
+      virtual size_t write(uint8_t c) { text += (char)c; return 1; }
+  };
+
+  void jsonCases()
+  {
+    test("json-by-type", []() {
+      Devices devices(4);
+      FixedDevice dev(1, 3);
+      devices.add(dev);
+      dev[0] = SensorReading(FirstSensorType, 1L);
+      dev[1] = SensorReading(Motion, true);   // the last sensor type
+
+      // every type from the first to the last is grouped, the unwritten slot is not
+      TextPrint out;
+      {
+        PrintJsonStream json(out);
+        json.beginObject();
+        devices.jsonForEachBySensorType(json, false);
+        json.endObject();
+      }
+      CHECK(out.text == String("{\"") + SensorTypeName(FirstSensorType) + "\":[1],\"" + SensorTypeName(Motion) + "\":[true]}");
+      if(failures)
+        fprintf(stderr, "    %s\n", out.text.c_str());
+    });
+  }
+}
+
+
+// the test program has no sketch
+void setup() {}
+void loop() {}
+
+int main(int argc, char** argv)
+{
+  for(int i=1; i<argc; i++) {
+    const char* arg = argv[i];
+    if(strncmp(arg, "--filter=", 9)==0)
+      DevicesTest::filter = arg + 9;
+  }
+
+  // drivers print diagnostics, keep the output to the results
+  NimbleHost::setSerialEcho(false);
+  NimbleHost::useVirtualClock(true);
+
+  DevicesTest::slotCases();
+  DevicesTest::jsonCases();
+  fprintf(stderr, "%d failed\n", DevicesTest::failures);
+  return DevicesTest::failures;
+}
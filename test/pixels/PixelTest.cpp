@@ -0,0 +1,334 @@
+/**
+ * @file PixelTest.cpp
+ * @brief Golden image tests of the framebuffer rasterizers for the host (native) build.
+ * Each case draws into a cleared buffer, or the display panel for bars, and compares the bytes to a checked-in golden
+ * image in test/pixels/golden. The golden images are plain PBM (P1) files, one character per pixel, so a change shows
+ * up readable in a diff and any image viewer can open them. Run from the project root, the exit code is the number of failed cases:
+ *   pio run -e native-pixels && .pio/build/native-pixels/program [--filter=circle] [--update]
+ * --update rewrites the golden images from the current output, review the diff before committing it.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <NimbleHost.h>
+#include <FrameBuffer.h>
+#include <Display.h>
+#include <Devices.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace Pixels {
+
+  // size of the buffer the FrameBuffer cases draw into, the height is a whole number of pages
+  const short Width = 48;
+  const short Height = 32;
+
+  struct Options {
+    const char* filter;
+    const char* golden;
+    bool update;
+
+    inline Options() : filter(NULL), golden("test/pixels/golden"), update(false) {}
+  };
+
+  static Options options;
+  static int failures = 0;
+
+  typedef std::vector<uint8_t> Image;
+
+  static inline bool bit(const Image& img, short width, short x, short y)
+  {
+    return (img[x + (y >> 3) * width] >> (y & 7)) & 1;
+  }
+
+  static std::string goldenPath(const char* name)
+  {
+    return std::string(options.golden) + "/" + name + ".pbm";
+  }
+
+  static bool writeGolden(const char* name, const Image& img, short width, short height)
+  {
+    FILE* f = fopen(goldenPath(name).c_str(), "w");
+    if(f == NULL)
+      return false;
+    fprintf(f, "P1\n# %s\n%d %d\n", name, width, height);
+    for(short y=0; y<height; y++) {
+      for(short x=0; x<width; x++)
+        fputc(bit(img, width, x, y) ? '1' : '0', f);
+      fputc('\n', f);
+    }
+    fclose(f);
+    return true;
+  }
+
+  // reads a plain PBM into page layout, false if the file is missing or malformed
+  static bool readGolden(const char* name, Image& img, short& width, short& height)
+  {
+    FILE* f = fopen(goldenPath(name).c_str(), "r");
+    if(f == NULL)
+      return false;
+
+    int c, w = 0, h = 0;
+    bool ok = fgetc(f)=='P' && fgetc(f)=='1';
+    while(ok && (c = fgetc(f)) != EOF && (c=='#' || isspace(c)))
+      if(c == '#')
+        while((c = fgetc(f)) != EOF && c != '\n');
+    if(ok && c != EOF)
+      ungetc(c, f);
+    ok = ok && fscanf(f, "%d %d", &w, &h) == 2 && w > 0 && h > 0 && (h & 7) == 0;
+    if(ok) {
+      width = w;
+      height = h;
+      img.assign(w * h / 8, 0);
+      for(int i=0; ok && i < w*h; ) {
+        c = fgetc(f);
+        if(c == '0' || c == '1') {
+          if(c == '1')
+            img[(i % w) + ((i / w) >> 3) * w] |= (uint8_t)(1 << ((i / w) & 7));
+          i++;
+        } else if(c == EOF || !isspace(c))
+          ok = false;
+      }
+    }
+    fclose(f);
+    return ok;
+  }
+
+  static void printImage(const Image& img, short width, short height, const Image* other)
+  {
+    for(short y=0; y<height; y++) {
+      fprintf(stderr, "    ");
+      for(short x=0; x<width; x++) {
+        bool b = bit(img, width, x, y);
+        fputc((other && b != bit(*other, width, x, y)) ? (b ? 'X' : 'o') : (b ? '#' : '.'), stderr);
+      }
+      fputc('\n', stderr);
+    }
+  }
+
+  static void check(const char* name, const Image& img, short width, short height)
+  {
+    if(options.update) {
+      if(!writeGolden(name, img, width, height)) {
+        fprintf(stderr, "FAIL %s: cannot write %s\n", name, goldenPath(name).c_str());
+        failures++;
+      } else
+        fprintf(stderr, "updated %s\n", goldenPath(name).c_str());
+      return;
+    }
+
+    Image golden;
+    short gw, gh;
+    if(!readGolden(name, golden, gw, gh)) {
+      fprintf(stderr, "FAIL %s: missing or malformed golden image %s\n", name, goldenPath(name).c_str());
+      failures++;
+      return;
+    }
+    if(gw != width || gh != height) {
+      fprintf(stderr, "FAIL %s: golden image is %dx%d, drew %dx%d\n", name, gw, gh, width, height);
+      failures++;
+      return;
+    }
+    if(golden == img) {
+      fprintf(stderr, "ok   %s\n", name);
+      return;
+    }
+
+    // X is drawn but should not be, o is missing
+    size_t i = 0;
+    while(golden[i] == img[i])
+      i++;
+    fprintf(stderr, "FAIL %s: first difference at byte %u, page %u column %u\n", name, (unsigned)i,
+      (unsigned)(i / width), (unsigned)(i % width));
+    printImage(img, width, height, &golden);
+    failures++;
+  }
+
+  static bool selected(const char* name)
+  {
+    return options.filter == NULL || strstr(name, options.filter) != NULL;
+  }
+
+  /// @brief draw into a cleared buffer of the test size and compare it to the golden image of the same name
+  static void test(const char* name, std::function<void(FrameBuffer& fb)> draw)
+  {
+    if(!selected(name))
+      return;
+    Image img(Width * Height / 8, 0);
+    FrameBuffer fb(img.data(), Width, Height);
+    draw(fb);
+    check(name, img, Width, Height);
+  }
+
+  void framebufferCases()
+  {
+    test("line", [](FrameBuffer& fb) {
+      fb.line(1, 1, 46, 1);           // horizontal
+      fb.line(1, 3, 1, 30);           // vertical, crossing pages
+      fb.line(3, 3, 44, 12);          // shallow
+      fb.line(3, 30, 12, 5);          // steep, drawn upwards
+      fb.line(44, 30, 20, 18);        // shallow, right to left
+      fb.line(30, 14, 33, 17);        // diagonal
+      fb.line(40, 20, 40, 20);        // a single point
+      fb.line(14, 24, 46, 24, 2);     // inverted where it crosses the line above
+    });
+
+    test("rect", [](FrameBuffer& fb) {
+      fb.rect(0, 0, 48, 32);          // the whole buffer
+      fb.rect(2, 2, 20, 10);          // within a page boundary
+      fb.rect(24, 5, 20, 20);         // crossing pages
+      fb.rect(4, 14, 1, 1);           // a single pixel
+      fb.rect(7, 14, 12, 1);          // one row
+      fb.rect(7, 17, 1, 12);          // one column
+      fb.rect(10, 17, 2, 2);          // no inside
+      fb.rect(14, 17, 0, 5);          // nothing
+      fb.rect(26, 7, 16, 16, 2);      // invert inside the one above
+    });
+
+    test("fillrect", [](FrameBuffer& fb) {
+      fb.fillRect(2, 2, 20, 28);          // spans every page
+      fb.fillRect(6, 10, 12, 4, 0);       // clear inside a page
+      fb.fillRect(6, 7, 4, 2, 0);         // clear across a page boundary
+      fb.fillRect(25, 3, 10, 3);          // inside one page
+      fb.fillRect(25, 9, 20, 20);         // crossing pages
+      fb.fillRect(30, 14, 10, 10, 2);     // invert
+      fb.fillRect(38, 1, 1, 1);           // a single pixel
+      fb.fillRect(40, 1, 5, 0);           // nothing
+    });
+
+    test("circle", [](FrameBuffer& fb) {
+      fb.circle(4, 4, 0);             // a single pixel
+      fb.circle(10, 4, 1);
+      fb.circle(18, 5, 3);
+      fb.circle(15, 20, 10);          // crossing pages
+      fb.circle(38, 15, 8);
+      fb.circle(38, 15, 5, 2);        // invert
+      fb.circle(30, 28, -1);          // nothing
+    });
+
+    test("fillcircle", [](FrameBuffer& fb) {
+      fb.fillCircle(3, 3, 0);         // a single pixel
+      fb.fillCircle(9, 3, 1);
+      fb.fillCircle(16, 4, 3);
+      fb.fillCircle(13, 20, 10);      // crossing pages
+      fb.fillCircle(37, 15, 8);
+      fb.fillCircle(37, 15, 4, 0);    // clear
+      fb.fillCircle(31, 22, 5, 2);    // invert across both circles
+      fb.fillCircle(30, 28, -1);      // nothing
+    });
+
+    test("clipping", [](FrameBuffer& fb) {
+      fb.line(-10, -6, 60, 40);           // through the buffer, both ends outside
+      fb.line(-5, 30, 100, 28);           // shallow, off both sides
+      fb.line(46, -20, 40, 50);           // steep, off top and bottom
+      fb.line(-20, 10, -2, 12);           // entirely outside
+      fb.rect(-4, -4, 12, 10);            // top left corner
+      fb.rect(40, 26, 20, 20);            // bottom right corner
+      fb.fillRect(-3, 14, 6, 30);         // left and bottom edges
+      fb.fillRect(44, -8, 10, 14);        // right and top edges
+      fb.fillRect(50, 40, 4, 4);          // entirely outside
+      fb.circle(20, -3, 7);               // top edge
+      fb.circle(24, 16, 30);              // larger than the buffer
+      fb.fillCircle(30, 34, 6);           // bottom edge
+      fb.fillCircle(-100, 10, 5);         // entirely outside
+      fb.hspan(-10, 100, 20, 2);          // full width, inverted
+      fb.vspan(22, -10, 100, 2);          // full height, inverted
+      fb.pixel(-1, 0);
+      fb.pixel(48, 31);
+      fb.pixel(0, 32);
+    });
+  }
+
+
+  /// @brief A device with readings set by the test
+  class FixedDevice : public Device
+  {
+    public:
+      inline FixedDevice(short id, short slots) : Device(id, slots) {}
+      virtual const char* getDriverName() const { return "Fixed"; }
+  };
+
+  // bars are drawn by the display at its cursor from a reading, the whole panel is compared
+  static void barTest(const char* name, Display& display, const char* code)
+  {
+    if(!selected(name))
+      return;
+    ParseException pex;
+    if(!display.execute(code, &pex)) {
+      fprintf(stderr, "FAIL %s: %s at position %d\n", name, ParseExceptionCodeToString(pex.code), pex.position);
+      failures++;
+      return;
+    }
+    short w = display.display.width(), h = display.display.height();
+    const uint8_t* panel = display.display.getBuffer();
+    check(name, Image(panel, panel + w * h / 8), w, h);
+  }
+
+  void barCases()
+  {
+    ESP8266WebServer server(80);
+    WiFiUDP udp;
+    NTPClient ntp(udp);
+    Devices devices(4);
+    devices.begin(server, ntp);
+    Display display(1);
+    FixedDevice readings(2, 4);
+    devices.add(display);
+    devices.add(readings);
+    readings[0] = SensorReading(Numeric, 50L);
+    readings[1] = SensorReading(Numeric, 0.25f);
+    readings[2] = SensorReading(Numeric, 150L);
+    readings[3] = SensorReading(Numeric, -20L);
+
+    // wide bars fill left to right, tall bars bottom up, without a range 0-100 is used. Registers keep their value
+    // from one code to the next so each bar after the first sets its range.
+    barTest("bar", display,
+      "G9 X1 Y1 W40 H6 D2 S0\n"                 // half
+      "G9 X1 Y9 W40 H6 D2 S1 A0 B1\n"           // a quarter of a 0-1 range
+      "G9 X1 Y17 W20 H6 D2 S2 A0 B100\n"        // over the range, full
+      "G9 X23 Y17 W20 H6 D2 S3\n"               // under the range, empty
+      "G9 X1 Y25 W30 H5 D2 S9\n"                // missing reading, only the outline
+      "G9 X34 Y25 W2 H5 D2 S0\n"                // too small to fill
+      "G9 X46 Y1 W5 H22 D2 S0 A0 B200"          // tall, a quarter
+    );
+
+    // bars straddling the edges of the panel
+    barTest("bar-clipped", display,
+      "G9 X-10 Y2 W30 H8 D2 S0 A0 B100\n"       // off the left
+      "G9 X40 Y-4 W20 H10 D2 S0 A0 B40\n"       // off the top, over the range
+      "G9 X120 Y40 W20 H30 D2 S0 A0 B100"       // off the right and bottom
+    );
+  }
+}
+
+
+// the test program has no sketch
+void setup() {}
+void loop() {}
+
+int main(int argc, char** argv)
+{
+  for(int i=1; i<argc; i++) {
+    const char* arg = argv[i];
+    if(strncmp(arg, "--filter=", 9)==0)
+      Pixels::options.filter = arg + 9;
+    else if(strncmp(arg, "--golden=", 9)==0)
+      Pixels::options.golden = arg + 9;
+    else if(strcmp(arg, "--update")==0)
+      Pixels::options.update = true;
+  }
+
+  // drivers print diagnostics, keep the output to the results
+  NimbleHost::setSerialEcho(false);
+  NimbleHost::useVirtualClock(true);
+
+  Pixels::framebufferCases();
+  Pixels::barCases();
+  fprintf(stderr, "%d failed\n", Pixels::failures);
+  return Pixels::failures;
+}